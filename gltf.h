@@ -6,32 +6,551 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cctype>
+#include <map>
+#include <memory>
+#include <iterator>
+#include <cstring>
+#include <limits>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <cerrno>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#pragma push_macro("OPAQUE")
+#undef OPAQUE
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "json.hpp"
 using namespace nlohmann;
 
 
 namespace gltf{
+    class Arena
+    {
+    public:
+        Arena(size_t _blockSize = 1 << 20) : blockSize(_blockSize){}
+        ~Arena()
+        {
+            Release();
+        }
+        Arena(const Arena&) = delete;
+        Arena &operator=(const Arena&) = delete;
+
+        void *Allocate(size_t size, size_t alignment)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uintptr_t address = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            if (!cursor || address + size > (uintptr_t)limit)
+            {
+                size_t bytes = std::max(blockSize, size + alignment);
+                unsigned char *block = (unsigned char*)std::malloc(bytes);
+                if (!block)
+                {
+                    throw std::bad_alloc();
+                }
+                blocks.push_back(block);
+                cursor = block;
+                limit = block + bytes;
+                address = ((uintptr_t)cursor + alignment - 1) & ~(uintptr_t)(alignment - 1);
+            }
+            cursor = (unsigned char*)(address + size);
+            allocations++;
+            bytesAllocated += size;
+            return (void*)address;
+        }
+        void Release()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (unsigned char *block : blocks)
+            {
+                std::free(block);
+            }
+            blocks.clear();
+            cursor = nullptr;
+            limit = nullptr;
+            allocations = 0;
+            bytesAllocated = 0;
+        }
+        size_t Allocations() const
+        {
+            return allocations;
+        }
+        size_t Bytes() const
+        {
+            return bytesAllocated;
+        }
+        size_t Blocks() const
+        {
+            return blocks.size();
+        }
+
+    private:
+        size_t blockSize;
+        std::vector<unsigned char*> blocks;
+        unsigned char *cursor = nullptr;
+        unsigned char *limit = nullptr;
+        size_t allocations = 0;
+        size_t bytesAllocated = 0;
+        std::mutex mutex;
+    };
+    Arena *&CurrentArena()
+    {
+        static thread_local Arena *arena = nullptr;
+        return arena;
+    }
+    class ArenaScope
+    {
+    public:
+        ArenaScope(Arena *arena) : previous(CurrentArena())
+        {
+            CurrentArena() = arena;
+        }
+        ~ArenaScope()
+        {
+            CurrentArena() = previous;
+        }
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope &operator=(const ArenaScope&) = delete;
+
+    private:
+        Arena *previous;
+    };
+    template<class T>
+    struct ArenaAllocator
+    {
+        typedef T value_type;
+        typedef std::true_type propagate_on_container_copy_assignment;
+        typedef std::true_type propagate_on_container_move_assignment;
+        typedef std::true_type propagate_on_container_swap;
+
+        Arena *arena;
+
+        ArenaAllocator() : arena(CurrentArena()){}
+        template<class U>
+        ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena){}
+
+        T *allocate(size_t n)
+        {
+            if (arena)
+            {
+                return (T*)arena->Allocate(n * sizeof(T), alignof(T));
+            }
+            return (T*)::operator new(n * sizeof(T));
+        }
+        void deallocate(T *p, size_t)
+        {
+            if (!arena)
+            {
+                ::operator delete(p);
+            }
+        }
+        template<class U>
+        bool operator==(const ArenaAllocator<U> &other) const
+        {
+            return arena == other.arena;
+        }
+        template<class U>
+        bool operator!=(const ArenaAllocator<U> &other) const
+        {
+            return arena != other.arena;
+        }
+    };
+#ifdef GLTF_USE_ARENA
+    template<class T>
+    using Allocator = ArenaAllocator<T>;
+    class String : public std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>
+    {
+    public:
+        typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> Base;
+        using Base::Base;
+
+        String(){}
+        String(const Base &other) : Base(other){}
+        String(Base &&other) : Base(std::move(other)){}
+        String(const std::string &other) : Base(other.data(), other.size()){}
+        operator std::string() const
+        {
+            return std::string(data(), size());
+        }
+        friend bool operator==(const String &a, const String &b)
+        {
+            return a.compare(b) == 0;
+        }
+        friend bool operator!=(const String &a, const String &b)
+        {
+            return a.compare(b) != 0;
+        }
+        friend bool operator==(const String &a, const char *b)
+        {
+            return a.compare(b) == 0;
+        }
+        friend bool operator!=(const String &a, const char *b)
+        {
+            return a.compare(b) != 0;
+        }
+        friend bool operator==(const String &a, const std::string &b)
+        {
+            return a.compare(0, a.size(), b.data(), b.size()) == 0;
+        }
+        friend bool operator!=(const String &a, const std::string &b)
+        {
+            return !(a == b);
+        }
+        friend bool operator==(const std::string &a, const String &b)
+        {
+            return b == a;
+        }
+        friend bool operator!=(const std::string &a, const String &b)
+        {
+            return !(b == a);
+        }
+        friend std::string operator+(const char *a, const String &b)
+        {
+            return a + std::string(b);
+        }
+        friend std::string operator+(const String &a, const char *b)
+        {
+            return std::string(a) + b;
+        }
+    };
+#else
+    template<class T>
+    using Allocator = std::allocator<T>;
+    typedef std::string String;
+#endif
+    template<class T>
+    using Vector = std::vector<T, Allocator<T>>;
+    uint64_t HashBytes(const void *data, size_t size)
+    {
+        const unsigned char *p = (const unsigned char*)data;
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash = (hash ^ p[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+    class Name
+    {
+    public:
+        Name() : value(&Empty()){}
+        explicit Name(const String *_value) : value(_value){}
+
+        const String &str() const
+        {
+            return *value;
+        }
+        const char *c_str() const
+        {
+            return value->c_str();
+        }
+        size_t size() const
+        {
+            return value->size();
+        }
+        bool empty() const
+        {
+            return value->empty();
+        }
+        operator const String&() const
+        {
+            return *value;
+        }
+        bool operator==(const Name &other) const
+        {
+            return value == other.value || *value == *other.value;
+        }
+        bool operator!=(const Name &other) const
+        {
+            return !(*this == other);
+        }
+        bool operator<(const Name &other) const
+        {
+            return value != other.value && *value < *other.value;
+        }
+        bool operator==(const char *other) const
+        {
+            return *value == other;
+        }
+        bool operator!=(const char *other) const
+        {
+            return *value != other;
+        }
+        bool operator==(const String &other) const
+        {
+            return *value == other;
+        }
+        bool operator!=(const String &other) const
+        {
+            return *value != other;
+        }
+
+    private:
+        const String *value;
+
+        static const String &Empty()
+        {
+            static const String empty;
+            return empty;
+        }
+    };
+    class StringPool
+    {
+    public:
+        StringPool() = default;
+        StringPool(const StringPool&) = delete;
+        StringPool &operator=(const StringPool&) = delete;
+
+        Name Intern(const char *data, size_t size)
+        {
+            if (size == 0)
+            {
+                return Name();
+            }
+            uint64_t hash = HashBytes(data, size);
+            std::lock_guard<std::mutex> lock(mutex);
+            if ((count + 1) * 4 > slots.size() * 3)
+            {
+                Grow();
+            }
+            size_t mask = slots.size() - 1;
+            for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask)
+            {
+                const String *slot = slots[i];
+                if (!slot)
+                {
+                    if (blocks.empty() || blocks.back().size() == blocks.back().capacity())
+                    {
+                        blocks.emplace_back();
+                        blocks.back().reserve(BLOCK_SIZE);
+                    }
+                    blocks.back().emplace_back(data, size);
+                    count++;
+                    slots[i] = &blocks.back().back();
+                    hashes[i] = hash;
+                    return Name(slots[i]);
+                }
+                if (hashes[i] == hash && slot->size() == size && std::memcmp(slot->data(), data, size) == 0)
+                {
+                    return Name(slot);
+                }
+            }
+        }
+        Name Intern(const std::string &value)
+        {
+            return Intern(value.data(), value.size());
+        }
+        Name Intern(const char *value)
+        {
+            return Intern(value, std::strlen(value));
+        }
+        size_t size() const
+        {
+            return count;
+        }
+
+    private:
+        static const size_t BLOCK_SIZE = 4096;
+        Vector<Vector<String>> blocks;
+        size_t count = 0;
+        Vector<const String*> slots;
+        Vector<uint64_t> hashes;
+        std::mutex mutex;
+
+        void Grow()
+        {
+            size_t capacity = std::max(slots.size() * 2, (size_t)64);
+            Vector<const String*> previousSlots;
+            Vector<uint64_t> previousHashes;
+            previousSlots.swap(slots);
+            previousHashes.swap(hashes);
+            slots.assign(capacity, nullptr);
+            hashes.assign(capacity, 0);
+            size_t mask = slots.size() - 1;
+            for (size_t j = 0; j < previousSlots.size(); j++)
+            {
+                if (!previousSlots[j])
+                {
+                    continue;
+                }
+                size_t i = (size_t)previousHashes[j] & mask;
+                while (slots[i])
+                {
+                    i = (i + 1) & mask;
+                }
+                slots[i] = previousSlots[j];
+                hashes[i] = previousHashes[j];
+            }
+        }
+    };
+    enum class AccessorType
+    {
+        SCALAR,
+        VEC2,
+        VEC3,
+        VEC4,
+        MAT2,
+        MAT3,
+        MAT4
+    };
+    enum class AnimationPath
+    {
+        TRANSLATION,
+        ROTATION,
+        SCALE,
+        WEIGHTS,
+        UNKNOWN
+    };
+    enum class Interpolation
+    {
+        LINEAR,
+        STEP,
+        CUBICSPLINE
+    };
+    enum class AlphaMode
+    {
+        OPAQUE,
+        MASK,
+        BLEND
+    };
+    enum class CameraType
+    {
+        PERSPECTIVE,
+        ORTHOGRAPHIC
+    };
+    AccessorType ParseAccessorType(const std::string &type)
+    {
+        if (type == "SCALAR") return AccessorType::SCALAR;
+        if (type == "VEC2") return AccessorType::VEC2;
+        if (type == "VEC3") return AccessorType::VEC3;
+        if (type == "VEC4") return AccessorType::VEC4;
+        if (type == "MAT2") return AccessorType::MAT2;
+        if (type == "MAT3") return AccessorType::MAT3;
+        if (type == "MAT4") return AccessorType::MAT4;
+        throw std::invalid_argument("gltf: unknown accessor type " + type);
+    }
+    AnimationPath ParseAnimationPath(const std::string &path)
+    {
+        if (path == "translation") return AnimationPath::TRANSLATION;
+        if (path == "rotation") return AnimationPath::ROTATION;
+        if (path == "scale") return AnimationPath::SCALE;
+        if (path == "weights") return AnimationPath::WEIGHTS;
+        return AnimationPath::UNKNOWN;
+    }
+    Interpolation ParseInterpolation(const std::string &interpolation)
+    {
+        if (interpolation == "LINEAR") return Interpolation::LINEAR;
+        if (interpolation == "STEP") return Interpolation::STEP;
+        if (interpolation == "CUBICSPLINE") return Interpolation::CUBICSPLINE;
+        throw std::invalid_argument("gltf: unknown interpolation " + interpolation);
+    }
+    AlphaMode ParseAlphaMode(const std::string &alphaMode)
+    {
+        if (alphaMode == "OPAQUE") return AlphaMode::OPAQUE;
+        if (alphaMode == "MASK") return AlphaMode::MASK;
+        if (alphaMode == "BLEND") return AlphaMode::BLEND;
+        throw std::invalid_argument("gltf: unknown alphaMode " + alphaMode);
+    }
+    CameraType ParseCameraType(const std::string &type)
+    {
+        if (type == "perspective") return CameraType::PERSPECTIVE;
+        if (type == "orthographic") return CameraType::ORTHOGRAPHIC;
+        throw std::invalid_argument("gltf: unknown camera type " + type);
+    }
+    const char *ToString(AccessorType type)
+    {
+        static const char *const names[] = {"SCALAR", "VEC2", "VEC3", "VEC4", "MAT2", "MAT3", "MAT4"};
+        return names[(int)type];
+    }
+    const char *ToString(AnimationPath path)
+    {
+        static const char *const names[] = {"translation", "rotation", "scale", "weights", ""};
+        return names[(int)path];
+    }
+    const char *ToString(Interpolation interpolation)
+    {
+        static const char *const names[] = {"LINEAR", "STEP", "CUBICSPLINE"};
+        return names[(int)interpolation];
+    }
+    const char *ToString(AlphaMode alphaMode)
+    {
+        static const char *const names[] = {"OPAQUE", "MASK", "BLEND"};
+        return names[(int)alphaMode];
+    }
+    const char *ToString(CameraType type)
+    {
+        static const char *const names[] = {"perspective", "orthographic"};
+        return names[(int)type];
+    }
+    struct AccessorSparseIndices
+    {
+        int bufferView = -1;
+        uint64_t byteOffset = 0;
+        int componentType = -1;
+    };
+    struct AccessorSparseValues
+    {
+        int bufferView = -1;
+        uint64_t byteOffset = 0;
+    };
+    struct AccessorSparse
+    {
+        uint64_t count = 0;
+        AccessorSparseIndices indices;
+        AccessorSparseValues values;
+    };
     struct Accessor
     {
         int bufferView = -1;
-        int byteOffset = 0;
+        uint64_t byteOffset = 0;
         int componentType = -1;
         bool normalized = false;
-        int count = -1;
-        std::string type;
-        std::vector<float> min;
-        std::vector<float> max;
+        uint64_t count = 0;
+        AccessorType type = AccessorType::SCALAR;
+        Vector<float> min;
+        Vector<float> max;
+        AccessorSparse sparse;
 
         Accessor() = default;
-        Accessor(int _componentType, int _count, const std::string &_type) : componentType(_componentType), count(_count), type(_type){}
+        Accessor(int _componentType, uint64_t _count, AccessorType _type) : componentType(_componentType), count(_count), type(_type){}
+
+        bool hasSparse() const
+        {
+            return sparse.count > 0;
+        }
     };
     struct AnimationChannelTarget
     {
         int node = -1;
-        std::string path;
+        AnimationPath path = AnimationPath::TRANSLATION;
+        Name customPath;
 
         AnimationChannelTarget() = default;
-        AnimationChannelTarget(const std::string _path) : path(_path){}
+        AnimationChannelTarget(AnimationPath _path) : path(_path){}
     };
     struct AnimationChannel
     {
@@ -39,12 +558,12 @@ namespace gltf{
         AnimationChannelTarget target;
 
         AnimationChannel() = default;
-        AnimationChannel(int _sampler, const AnimationChannelTarget &_target) : sampler(_sampler), target(_target){}
+        AnimationChannel(int _sampler, AnimationChannelTarget _target) : sampler(_sampler), target(std::move(_target)){}
     };
     struct AnimationSampler
     {
         int input = -1;
-        std::string interpolation = "LINEAR";
+        Interpolation interpolation = Interpolation::LINEAR;
         int output = -1;
 
         AnimationSampler() = default;
@@ -52,43 +571,45 @@ namespace gltf{
     };
     struct Animation
     {
-        std::vector<AnimationChannel> channels;
-        std::vector<AnimationSampler> samplers;
-        std::string name;
+        Vector<AnimationChannel> channels;
+        Vector<AnimationSampler> samplers;
+        Name name;
 
         Animation() = default;
-        Animation(const std::vector<AnimationChannel> &_channels, const std::vector<AnimationSampler> &_samplers) : channels(_channels), samplers(_samplers){}
+        Animation(Vector<AnimationChannel> _channels, Vector<AnimationSampler> _samplers) : channels(std::move(_channels)), samplers(std::move(_samplers)){}
     };
     struct Asset
     {
-        std::string copyright;
-        std::string generator;
-        std::string version;
-        std::string minVersion;
+        String copyright;
+        String generator;
+        String version;
+        String minVersion;
 
         Asset() = default;
-        Asset(const std::string &_version) : version(_version){}
+        Asset(String _version) : version(std::move(_version)){}
     };
     struct Buffer
     {
-        std::string uri;
-        int byteLength = -1;
-        std::string name;
+        String uri;
+        uint64_t byteLength = 0;
+        Name name;
+        const unsigned char *data = nullptr;
+        std::shared_ptr<const std::vector<unsigned char>> storage;
 
         Buffer() = default;
-        Buffer(int _byteLength) : byteLength(_byteLength){}
+        Buffer(uint64_t _byteLength) : byteLength(_byteLength){}
     };
     struct BufferView
     {
         int buffer = -1;
-        int byteOffset = 0;
-        int byteLength = -1;
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
         int byteStride = -1;
         int target = -1;
-        std::string name;
+        Name name;
 
         BufferView() = default;
-        BufferView(int _buffer, int _byteLength) : buffer(_buffer), byteLength(_byteLength){}
+        BufferView(int _buffer, uint64_t _byteLength) : buffer(_buffer), byteLength(_byteLength){}
     };
     struct CameraOrthographic
     {
@@ -114,16 +635,18 @@ namespace gltf{
     {
         CameraOrthographic orthographic;
         CameraPerspective perspective;
-        std::string type;
+        CameraType type = CameraType::PERSPECTIVE;
+        Name name;
 
 
     };
     struct Image
     {
-        std::string uri;
-        std::string mimeType;
+        String uri;
+        String mimeType;
         int bufferView = -1;
-        std::string name;
+        Name name;
+        std::shared_ptr<const std::vector<unsigned char>> storage;
 
 
     };
@@ -168,30 +691,139 @@ namespace gltf{
     };
     struct Material
     {
-        std::string name;
+        Name name;
         MaterialPBRMetallicRoughness pbrMetallicRoughness;
         MaterialNormalTextureInfo normalTexture;
         MaterialOcclusionTextureInfo occlusionTexture;
         TextureInfo emissiveTexture;
         float emissiveFactor[3] = {0,0,0};
-        std::string alphaMode = "OPAQUE";
+        AlphaMode alphaMode = AlphaMode::OPAQUE;
         float alphaCutoff = 0.5;
         bool doubleSided = false;
     };
+    enum class AttributeSemantic
+    {
+        POSITION,
+        NORMAL,
+        TANGENT,
+        TEXCOORD,
+        COLOR,
+        JOINTS,
+        WEIGHTS,
+        CUSTOM
+    };
+    const int MAX_ATTRIBUTE_SETS = 8;
+    const int ATTRIBUTE_SLOT_COUNT = 3 + 4 * MAX_ATTRIBUTE_SETS;
+    int AttributeSlot(AttributeSemantic semantic, int set)
+    {
+        switch (semantic)
+        {
+            case AttributeSemantic::POSITION: return set == 0 ? 0 : -1;
+            case AttributeSemantic::NORMAL: return set == 0 ? 1 : -1;
+            case AttributeSemantic::TANGENT: return set == 0 ? 2 : -1;
+            default: break;
+        }
+        if (semantic == AttributeSemantic::CUSTOM || set < 0 || set >= MAX_ATTRIBUTE_SETS)
+        {
+            return -1;
+        }
+        return 3 + ((int)semantic - (int)AttributeSemantic::TEXCOORD) * MAX_ATTRIBUTE_SETS + set;
+    }
+    bool ParseAttributeName(const String &name, AttributeSemantic &semantic, int &set)
+    {
+        static const char *const names[] = {"POSITION", "NORMAL", "TANGENT", "TEXCOORD_", "COLOR_", "JOINTS_", "WEIGHTS_"};
+        set = 0;
+        for (int i = 0; i < 7; i++)
+        {
+            size_t length = std::strlen(names[i]);
+            if (name.compare(0, length, names[i]) != 0)
+            {
+                continue;
+            }
+            if (names[i][length - 1] != '_')
+            {
+                if (name.size() != length)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                if (name.size() == length || name.size() > length + 4)
+                {
+                    continue;
+                }
+                for (size_t j = length; j < name.size(); j++)
+                {
+                    if (name[j] < '0' || name[j] > '9')
+                    {
+                        return false;
+                    }
+                    set = set * 10 + (name[j] - '0');
+                }
+            }
+            semantic = (AttributeSemantic)i;
+            return true;
+        }
+        semantic = AttributeSemantic::CUSTOM;
+        return false;
+    }
+    int AttributeSlot(const String &name)
+    {
+        AttributeSemantic semantic;
+        int set;
+        return ParseAttributeName(name, semantic, set) ? AttributeSlot(semantic, set) : -1;
+    }
     struct MeshPrimitive
     {
-        std::vector<std::pair<std::string, int>> attributes;
+        Vector<std::pair<Name, int>> attributes;
+        Vector<Vector<std::pair<Name, int>>> targets;
         int indices = -1;
         int material = -1;
         int mode = 4;
+        int slots[ATTRIBUTE_SLOT_COUNT];
+        std::map<String, int> customAttributes;
 
-        MeshPrimitive() = default;
-        MeshPrimitive(const std::vector<std::pair<std::string, int>>& _attributes) : attributes(_attributes){}
+        MeshPrimitive()
+        {
+            std::fill(slots, slots + ATTRIBUTE_SLOT_COUNT, -1);
+        }
+        MeshPrimitive(Vector<std::pair<Name, int>> _attributes) : attributes(std::move(_attributes))
+        {
+            Resolve();
+        }
 
-        int Find(const std::string& key) const
+        void Resolve()
+        {
+            std::fill(slots, slots + ATTRIBUTE_SLOT_COUNT, -1);
+            customAttributes.clear();
+            for (const std::pair<Name, int> &attribute : attributes)
+            {
+                int slot = AttributeSlot(attribute.first.str());
+                if (slot >= 0)
+                {
+                    slots[slot] = attribute.second;
+                }
+                else
+                {
+                    customAttributes[attribute.first.str()] = attribute.second;
+                }
+            }
+        }
+        int Find(AttributeSemantic semantic, int set = 0) const
+        {
+            int slot = AttributeSlot(semantic, set);
+            return slot >= 0 ? slots[slot] : -1;
+        }
+        int Find(const String& key) const
         {
-            const std::vector<std::pair<std::string, int>>::const_iterator& found = std::find_if(attributes.begin(), attributes.end(), [&key](const std::pair<std::string, int>& item){return item.first == key;});
-            if (found != attributes.end())
+            int slot = AttributeSlot(key);
+            if (slot >= 0)
+            {
+                return slots[slot];
+            }
+            const std::map<String, int>::const_iterator found = customAttributes.find(key);
+            if (found != customAttributes.end())
             {
                 return found->second;
             }
@@ -200,25 +832,25 @@ namespace gltf{
     };
     struct Mesh
     {
-        std::vector<MeshPrimitive> primitives;
-        std::vector<float> weights;
-        std::string name;
+        Vector<MeshPrimitive> primitives;
+        Vector<float> weights;
+        Name name;
 
         Mesh() = default;
-        Mesh(const std::vector<MeshPrimitive> _primitives) : primitives(_primitives){}
+        Mesh(Vector<MeshPrimitive> _primitives) : primitives(std::move(_primitives)){}
     };
     struct Node
     {
         int camera = -1;
-        std::vector<int> children;
+        Vector<int> children;
         int skin = -1;
         float matrix[16] = {1,0,0,0, 0,1,0,0, 0,0,1,0, 0,0,0,1};
         int mesh = -1;
         float rotation[4] = {0,0,0,1};
         float scale[3] = {1,1,1};
         float translation[3] = {0,0,0};
-        std::vector<float> weights;
-        std::string name;
+        Vector<float> weights;
+        Name name;
 
         bool hasMatrix() const
         {
@@ -263,17 +895,17 @@ namespace gltf{
         int minFilter = -1;
         int wrapS = 10497;
         int wrapT = 10497;
-        std::string name;
+        Name name;
 
-        std::string ToString() const
+        String ToString() const
         {
             return std::to_string(magFilter) + "," + std::to_string(minFilter) + "," + std::to_string(wrapS) + "," + std::to_string(wrapT);
         }
     };
     struct Scene
     {
-        std::vector<int> nodes;
-        std::string name;
+        Vector<int> nodes;
+        Name name;
 
 
     };
@@ -281,472 +913,6581 @@ namespace gltf{
     {
         int inverseBindMatrices = -1;
         int skeleton = -1;
-        std::vector<int> joints;
-        std::string name;
+        Vector<int> joints;
+        Name name;
 
         Skin() = default;
-        Skin(const std::vector<int> &_joints) : joints(_joints){}
+        Skin(Vector<int> _joints) : joints(std::move(_joints)){}
     };
     struct Texture
     {
         int sampler = -1;
         int source = -1;
-        std::string name;
+        Name name;
 
 
     };
     struct glTF
     {
-        std::vector<Accessor> accessors;
-        std::vector<Animation> animations;
+        Vector<Accessor> accessors;
+        Vector<Animation> animations;
         Asset asset;
-        std::vector<Buffer> buffers;
-        std::vector<BufferView> bufferViews;
-        std::vector<Camera> cameras;
-        std::vector<Image> images;
-        std::vector<Material> materials;
-        std::vector<Mesh> meshes;
-        std::vector<Node> nodes;
-        std::vector<Sampler> samplers;
+        Vector<Buffer> buffers;
+        Vector<BufferView> bufferViews;
+        Vector<Camera> cameras;
+        Vector<Image> images;
+        Vector<Material> materials;
+        Vector<Mesh> meshes;
+        Vector<Node> nodes;
+        Vector<Sampler> samplers;
         int scene;
-        std::vector<Scene> scenes;
-        std::vector<Skin> skins;
-        std::vector<Texture> textures;
+        Vector<Scene> scenes;
+        Vector<Skin> skins;
+        Vector<Texture> textures;
+        std::shared_ptr<StringPool> strings = std::make_shared<StringPool>();
 
         glTF() = default;
-        glTF(const Asset &_asset) : asset(_asset){}
+        glTF(Asset _asset) : asset(std::move(_asset)){}
     };
-    glTF Parse(const std::string &gltfText)
+    int ComponentSize(int componentType)
     {
-        json GLTF = json::parse(gltfText);
-        json ASSET = GLTF["asset"];
-        std::string version = ASSET["version"];
-        Asset asset(version);
-        glTF gltf(asset);
-
-        gltf.scene = GLTF.value("scene", -1);
-        if (GLTF.contains("scenes"))
+        switch (componentType)
         {
-            json SCENES = GLTF["scenes"];
-            for (int i = 0; i < SCENES.size(); i++)
-            {
-                json SCENE = SCENES.at(i);
-                Scene scene;
-                scene.name = SCENE.value("name","");
-                if (SCENE.contains("nodes"))
-                {
-                    json NODES = SCENE["nodes"];
-                    for (int j = 0; j < NODES.size(); j++)
-                    {
-                        scene.nodes.push_back(NODES.at(j));
-                    }
-                }
-                gltf.scenes.push_back(scene);
-            }
+            case 5120: case 5121: return 1;
+            case 5122: case 5123: return 2;
+            case 5125: case 5126: return 4;
         }
-        if (GLTF.contains("nodes"))
+        return 0;
+    }
+    int ComponentCount(AccessorType type)
+    {
+        static const int counts[] = {1, 2, 3, 4, 4, 9, 16};
+        return counts[(int)type];
+    }
+    uint64_t ToSize(const json &value)
+    {
+        if (!value.is_number_unsigned())
         {
-            json NODES = GLTF["nodes"];
-            for (int i = 0; i < NODES.size(); i++)
-            {
-                json NODE = NODES.at(i);
-                Node node;
-                node.camera = NODE.value("camera", -1);
-                if (NODE.contains("children"))
-                {
-                    json CHILDREN = NODE["children"];
-                    for (int j = 0; j < CHILDREN.size(); j++)
-                    {
-                        node.children.push_back(CHILDREN.at(j));
-                    }
-                }
-                if (NODE.contains("matrix"))
-                {
-                    json MATRIX = NODE["matrix"];
-                    for (int j = 0; j < MATRIX.size(); j++)
-                    {
-                        node.matrix[j] = MATRIX.at(j);
-                    }
-                }
-                node.mesh = NODE.value("mesh", -1);
-                node.name = NODE.value("name", "");
-                if (NODE.contains("rotation"))
-                {
-                    json ROTATION = NODE["rotation"];
-                    for (int j = 0; j < ROTATION.size(); j++)
-                    {
-                        node.rotation[j] = ROTATION.at(j);
-                    }
+            throw std::out_of_range("gltf: expected a non-negative integer, got " + value.dump());
+        }
+        return value.get<uint64_t>();
+    }
+    uint64_t ToSize(double value)
+    {
+        if (!(value >= 0) || value != std::floor(value) || value >= 18446744073709551616.0)
+        {
+            throw std::out_of_range("gltf: expected a non-negative integer, got " + std::to_string(value));
+        }
+        return (uint64_t)value;
+    }
+    uint64_t CheckedAdd(uint64_t a, uint64_t b)
+    {
+        if (b > std::numeric_limits<uint64_t>::max() - a)
+        {
+            throw std::overflow_error("gltf: byte range overflows 64 bits");
+        }
+        return a + b;
+    }
+    uint64_t CheckedMul(uint64_t a, uint64_t b)
+    {
+        if (a && b > std::numeric_limits<uint64_t>::max() / a)
+        {
+            throw std::overflow_error("gltf: byte range overflows 64 bits");
+        }
+        return a * b;
+    }
+    int PaddedColumns(const Accessor &accessor)
+    {
+        int componentSize = ComponentSize(accessor.componentType);
+        if (accessor.type == AccessorType::MAT2 && componentSize == 1)
+        {
+            return 2;
+        }
+        if (accessor.type == AccessorType::MAT3 && componentSize < 4)
+        {
+            return 3;
+        }
+        return 0;
+    }
+    uint64_t ElementSize(const Accessor &accessor)
+    {
+        int columns = PaddedColumns(accessor);
+        if (columns)
+        {
+            return (uint64_t)columns * ((ComponentSize(accessor.componentType) * columns + 3) & ~3);
+        }
+        return (uint64_t)ComponentSize(accessor.componentType) * ComponentCount(accessor.type);
+    }
+    uint64_t ElementStride(const Accessor &accessor, const BufferView &bufferView)
+    {
+        return bufferView.byteStride > 0 ? (uint64_t)bufferView.byteStride : ElementSize(accessor);
+    }
+    uint64_t AccessorByteLength(const Accessor &accessor, const BufferView &bufferView)
+    {
+        if (accessor.count == 0)
+        {
+            return 0;
+        }
+        return CheckedAdd(CheckedMul(accessor.count - 1, ElementStride(accessor, bufferView)), ElementSize(accessor));
+    }
+    void Validate(const glTF &gltf)
+    {
+        for (size_t i = 0; i < gltf.buffers.size(); i++)
+        {
+            const Buffer &buffer = gltf.buffers[i];
+            if (buffer.storage && buffer.storage->size() < buffer.byteLength)
+            {
+                throw std::out_of_range("gltf: buffer " + std::to_string(i) + " data is shorter than byteLength");
+            }
+        }
+        for (size_t i = 0; i < gltf.bufferViews.size(); i++)
+        {
+            const BufferView &bufferView = gltf.bufferViews[i];
+            if (bufferView.buffer < 0 || bufferView.buffer >= (int)gltf.buffers.size())
+            {
+                throw std::out_of_range("gltf: bufferView " + std::to_string(i) + " references a missing buffer");
+            }
+            if (CheckedAdd(bufferView.byteOffset, bufferView.byteLength) > gltf.buffers[bufferView.buffer].byteLength)
+            {
+                throw std::out_of_range("gltf: bufferView " + std::to_string(i) + " exceeds its buffer");
+            }
+        }
+        for (size_t i = 0; i < gltf.accessors.size(); i++)
+        {
+            const Accessor &accessor = gltf.accessors[i];
+            if (accessor.hasSparse())
+            {
+                const AccessorSparse &sparse = accessor.sparse;
+                if (sparse.count > accessor.count)
+                {
+                    throw std::out_of_range("gltf: accessor " + std::to_string(i) + " has more sparse values than elements");
+                }
+                if (sparse.indices.bufferView < 0 || sparse.indices.bufferView >= (int)gltf.bufferViews.size() || sparse.values.bufferView < 0 || sparse.values.bufferView >= (int)gltf.bufferViews.size())
+                {
+                    throw std::out_of_range("gltf: accessor " + std::to_string(i) + " sparse references a missing bufferView");
+                }
+                uint64_t indicesLength = CheckedMul(sparse.count, ComponentSize(sparse.indices.componentType));
+                uint64_t valuesLength = CheckedMul(sparse.count, ElementSize(accessor));
+                if (CheckedAdd(sparse.indices.byteOffset, indicesLength) > gltf.bufferViews[sparse.indices.bufferView].byteLength || CheckedAdd(sparse.values.byteOffset, valuesLength) > gltf.bufferViews[sparse.values.bufferView].byteLength)
+                {
+                    throw std::out_of_range("gltf: accessor " + std::to_string(i) + " sparse data exceeds its bufferView");
+                }
+            }
+            if (accessor.bufferView < 0)
+            {
+                continue;
+            }
+            if (accessor.bufferView >= (int)gltf.bufferViews.size())
+            {
+                throw std::out_of_range("gltf: accessor " + std::to_string(i) + " references a missing bufferView");
+            }
+            const BufferView &bufferView = gltf.bufferViews[accessor.bufferView];
+            if (CheckedAdd(accessor.byteOffset, AccessorByteLength(accessor, bufferView)) > bufferView.byteLength)
+            {
+                throw std::out_of_range("gltf: accessor " + std::to_string(i) + " exceeds its bufferView");
+            }
+        }
+    }
+    struct ParseOptions
+    {
+        int threads = 1;
+        size_t chunkSize = 4096;
+
+        ParseOptions() = default;
+        ParseOptions(int _threads) : threads(_threads){}
+    };
+    void RunTasks(const std::vector<std::function<void()>> &tasks, int threads)
+    {
+        if (threads <= 0)
+        {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        size_t workers = std::min((size_t)threads, tasks.size());
+        if (workers <= 1)
+        {
+            for (const std::function<void()> &task : tasks)
+            {
+                task();
+            }
+            return;
+        }
+        std::atomic<size_t> next(0);
+        std::mutex errorMutex;
+        std::exception_ptr error;
+        Arena *arena = CurrentArena();
+        std::function<void()> work = [&]()
+        {
+            ArenaScope scope(arena);
+            for (size_t i = next++; i < tasks.size(); i = next++)
+            {
+                try
+                {
+                    tasks[i]();
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    next = tasks.size();
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (size_t i = 1; i < workers; i++)
+        {
+            pool.emplace_back(work);
+        }
+        work();
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+    template<typename T>
+    void AddParseTasks(std::vector<std::function<void()>> &tasks, const json &GLTF, const char *key, Vector<T> &items, void (*parse)(const json&, T&, StringPool&), StringPool &strings, size_t chunkSize)
+    {
+        if (!GLTF.contains(key))
+        {
+            return;
+        }
+        const json &ITEMS = GLTF.at(key);
+        items.resize(ITEMS.size());
+        chunkSize = std::max(chunkSize, (size_t)1);
+        for (size_t begin = 0; begin < items.size(); begin += chunkSize)
+        {
+            size_t end = std::min(begin + chunkSize, items.size());
+            tasks.push_back([&ITEMS, &items, parse, &strings, begin, end]()
+            {
+                for (size_t i = begin; i < end; i++)
+                {
+                    parse(ITEMS.at(i), items[i], strings);
+                }
+            });
+        }
+    }
+    struct Base64Lookup
+    {
+        signed char table[256];
+
+        Base64Lookup()
+        {
+            const char *alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            std::fill(table, table + 256, (signed char)-1);
+            for (int i = 0; i < 64; i++)
+            {
+                table[(unsigned char)alphabet[i]] = (signed char)i;
+            }
+        }
+    };
+    const signed char *Base64Table()
+    {
+        static const Base64Lookup lookup;
+        return lookup.table;
+    }
+#if defined(__AVX2__) || defined(__SSSE3__)
+    bool DecodeBase64Block(__m128i in, unsigned char *out)
+    {
+        const __m128i LUT_LO = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m128i LUT_HI = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m128i LUT_ROLL = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i MASK_2F = _mm_set1_epi8(0x2F);
+        __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), MASK_2F);
+        __m128i lo = _mm_shuffle_epi8(LUT_LO, _mm_and_si128(in, MASK_2F));
+        __m128i hi = _mm_shuffle_epi8(LUT_HI, hiNibbles);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0xFFFF)
+        {
+            return false;
+        }
+        __m128i roll = _mm_shuffle_epi8(LUT_ROLL, _mm_add_epi8(_mm_cmpeq_epi8(in, MASK_2F), hiNibbles));
+        __m128i values = _mm_add_epi8(in, roll);
+        __m128i merged = _mm_madd_epi16(_mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140)), _mm_set1_epi32(0x00011000));
+        __m128i packed = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*)out, packed);
+        return true;
+    }
+#endif
+#if defined(__AVX2__)
+    bool DecodeBase64Block(__m256i in, unsigned char *out)
+    {
+        const __m256i LUT_LO = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+        const __m256i LUT_HI = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+        const __m256i LUT_ROLL = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m256i MASK_2F = _mm256_set1_epi8(0x2F);
+        __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), MASK_2F);
+        __m256i lo = _mm256_shuffle_epi8(LUT_LO, _mm256_and_si256(in, MASK_2F));
+        __m256i hi = _mm256_shuffle_epi8(LUT_HI, hiNibbles);
+        if (!_mm256_testz_si256(lo, hi))
+        {
+            return false;
+        }
+        __m256i roll = _mm256_shuffle_epi8(LUT_ROLL, _mm256_add_epi8(_mm256_cmpeq_epi8(in, MASK_2F), hiNibbles));
+        __m256i values = _mm256_add_epi8(in, roll);
+        __m256i merged = _mm256_madd_epi16(_mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140)), _mm256_set1_epi32(0x00011000));
+        __m256i packed = _mm256_shuffle_epi8(merged, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+        _mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(packed, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7)));
+        return true;
+    }
+#endif
+    size_t Base64DecodedSize(const char *src, size_t n)
+    {
+        while (n > 0 && src[n - 1] == '=')
+        {
+            n--;
+        }
+        if (n % 4 == 1)
+        {
+            throw std::invalid_argument("gltf: truncated base64 data");
+        }
+        return n / 4 * 3 + (n % 4 ? n % 4 - 1 : 0);
+    }
+    size_t DecodeBase64(const char *src, size_t n, unsigned char *out)
+    {
+        size_t padding = 0;
+        while (n > 0 && src[n - 1] == '=' && padding < 2)
+        {
+            n--;
+            padding++;
+        }
+        size_t size = Base64DecodedSize(src, n);
+        const char *p = src;
+        const char *last = src + n;
+#if defined(__AVX2__) || defined(__SSSE3__)
+        unsigned char *end = out + size;
+#endif
+#if defined(__AVX2__)
+        while (last - p >= 32 && end - out >= 32)
+        {
+            if (!DecodeBase64Block(_mm256_loadu_si256((const __m256i*)p), out))
+            {
+                break;
+            }
+            p += 32;
+            out += 24;
+        }
+#endif
+#if defined(__AVX2__) || defined(__SSSE3__)
+        while (last - p >= 16 && end - out >= 16)
+        {
+            if (!DecodeBase64Block(_mm_loadu_si128((const __m128i*)p), out))
+            {
+                break;
+            }
+            p += 16;
+            out += 12;
+        }
+#endif
+        const signed char *table = Base64Table();
+        uint32_t bits = 0;
+        int count = 0;
+        for (; p < last; p++)
+        {
+            signed char value = table[(unsigned char)*p];
+            if (value < 0)
+            {
+                throw std::invalid_argument("gltf: invalid base64 character at offset " + std::to_string(p - src));
+            }
+            bits = (bits << 6) | (uint32_t)value;
+            if (++count == 4)
+            {
+                out[0] = (unsigned char)(bits >> 16);
+                out[1] = (unsigned char)(bits >> 8);
+                out[2] = (unsigned char)bits;
+                out += 3;
+                bits = 0;
+                count = 0;
+            }
+        }
+        if (count == 3)
+        {
+            out[0] = (unsigned char)(bits >> 10);
+            out[1] = (unsigned char)(bits >> 2);
+        }
+        else if (count == 2)
+        {
+            out[0] = (unsigned char)(bits >> 4);
+        }
+        return size;
+    }
+    bool IsDataURI(const std::string &uri)
+    {
+        return uri.compare(0, 5, "data:") == 0;
+    }
+    std::shared_ptr<const std::vector<unsigned char>> DecodeDataURI(const std::string &uri, std::string *mimeType = nullptr)
+    {
+        size_t comma = uri.find(',');
+        if (!IsDataURI(uri) || comma == std::string::npos)
+        {
+            throw std::invalid_argument("gltf: malformed data URI");
+        }
+        if (comma < 12 || uri.compare(comma - 7, 7, ";base64") != 0)
+        {
+            throw std::invalid_argument("gltf: only base64 data URIs are supported");
+        }
+        if (mimeType)
+        {
+            size_t end = uri.find(';', 5);
+            mimeType->assign(uri, 5, end - 5);
+        }
+        const char *src = uri.data() + comma + 1;
+        size_t n = uri.size() - comma - 1;
+        std::shared_ptr<std::vector<unsigned char>> bytes = std::make_shared<std::vector<unsigned char>>(Base64DecodedSize(src, n));
+        DecodeBase64(src, n, bytes->data());
+        return bytes;
+    }
+    void LoadBufferURI(Buffer &buffer, const std::string &uri)
+    {
+        if (IsDataURI(uri))
+        {
+            buffer.storage = DecodeDataURI(uri);
+            buffer.data = buffer.storage->data();
+        }
+        else
+        {
+            buffer.uri = uri;
+        }
+    }
+    void LoadImageURI(Image &image, const std::string &uri)
+    {
+        if (IsDataURI(uri))
+        {
+            std::string mimeType;
+            image.storage = DecodeDataURI(uri, &mimeType);
+            if (image.mimeType.empty())
+            {
+                image.mimeType = mimeType;
+            }
+        }
+        else
+        {
+            image.uri = uri;
+        }
+    }
+    Name ParseName(const json &OBJECT, StringPool &strings)
+    {
+        json::const_iterator NAME = OBJECT.find("name");
+        if (NAME == OBJECT.end())
+        {
+            return Name();
+        }
+        return strings.Intern(NAME->get_ref<const json::string_t&>());
+    }
+    void ParseCamera(const json &CAMERA, Camera &camera, StringPool &strings)
+    {
+        camera.type = ParseCameraType(CAMERA.at("type").get_ref<const json::string_t&>());
+        if (CAMERA.contains("orthographic"))
+        {
+            const json &ORTHOGRAPHIC = CAMERA.at("orthographic");
+            camera.orthographic = CameraOrthographic(ORTHOGRAPHIC.at("xmag"), ORTHOGRAPHIC.at("ymag"), ORTHOGRAPHIC.at("zfar"), ORTHOGRAPHIC.at("znear"));
+        }
+        if (CAMERA.contains("perspective"))
+        {
+            const json &PERSPECTIVE = CAMERA.at("perspective");
+            camera.perspective = CameraPerspective(PERSPECTIVE.at("yfov"), PERSPECTIVE.at("znear"));
+            camera.perspective.aspectRatio = PERSPECTIVE.value("aspectRatio", -1.0f);
+            camera.perspective.zfar = PERSPECTIVE.value("zfar", -1.0f);
+        }
+        camera.name = ParseName(CAMERA, strings);
+    }
+    void ParseScene(const json &SCENE, Scene &scene, StringPool &strings)
+    {
+        scene.name = ParseName(SCENE, strings);
+        if (SCENE.contains("nodes"))
+        {
+            const json &NODES = SCENE.at("nodes");
+            scene.nodes.reserve(NODES.size());
+            for (const json &NODE : NODES)
+            {
+                scene.nodes.push_back(NODE);
+            }
+        }
+    }
+    void ParseNode(const json &NODE, Node &node, StringPool &strings)
+    {
+        node.camera = NODE.value("camera", -1);
+        if (NODE.contains("children"))
+        {
+            const json &CHILDREN = NODE.at("children");
+            node.children.reserve(CHILDREN.size());
+            for (const json &CHILD : CHILDREN)
+            {
+                node.children.push_back(CHILD);
+            }
+        }
+        if (NODE.contains("matrix"))
+        {
+            const json &MATRIX = NODE.at("matrix");
+            for (int j = 0; j < MATRIX.size(); j++)
+            {
+                node.matrix[j] = MATRIX.at(j);
+            }
+        }
+        node.mesh = NODE.value("mesh", -1);
+        node.name = ParseName(NODE, strings);
+        if (NODE.contains("rotation"))
+        {
+            const json &ROTATION = NODE.at("rotation");
+            for (int j = 0; j < ROTATION.size(); j++)
+            {
+                node.rotation[j] = ROTATION.at(j);
+            }
+        }
+        if (NODE.contains("scale"))
+        {
+            const json &SCALE = NODE.at("scale");
+            for (int j = 0; j < SCALE.size(); j++)
+            {
+                node.scale[j] = SCALE.at(j);
+            }
+        }
+        node.skin = NODE.value("skin", -1);
+        if (NODE.contains("translation"))
+        {
+            const json &TRANSLATION = NODE.at("translation");
+            for (int j = 0; j < TRANSLATION.size(); j++)
+            {
+                node.translation[j] = TRANSLATION.at(j);
+            }
+        }
+    }
+    void ParseAnimation(const json &ANIMATION, Animation &animation, StringPool &strings)
+    {
+        const json &CHANNELS = ANIMATION.at("channels");
+        animation.channels.reserve(CHANNELS.size());
+        for (const json &CHANNEL : CHANNELS)
+        {
+            const json &TARGET = CHANNEL.at("target");
+            const json::string_t &PATH = TARGET.at("path").get_ref<const json::string_t&>();
+            AnimationChannelTarget target(ParseAnimationPath(PATH));
+            if (target.path == AnimationPath::UNKNOWN)
+            {
+                target.customPath = strings.Intern(PATH);
+            }
+            target.node = TARGET.value("node", -1);
+            int sampler = CHANNEL.at("sampler");
+            animation.channels.emplace_back(sampler, std::move(target));
+        }
+        const json &SAMPLERS = ANIMATION.at("samplers");
+        animation.samplers.reserve(SAMPLERS.size());
+        for (const json &SAMPLER : SAMPLERS)
+        {
+            int input = SAMPLER.at("input");
+            int output = SAMPLER.at("output");
+            animation.samplers.emplace_back(input, output);
+            if (SAMPLER.contains("interpolation"))
+            {
+                animation.samplers.back().interpolation = ParseInterpolation(SAMPLER.at("interpolation").get_ref<const json::string_t&>());
+            }
+        }
+        animation.name = ParseName(ANIMATION, strings);
+    }
+    void ParseMaterial(const json &MATERIAL, Material &material, StringPool &strings)
+    {
+        if (MATERIAL.contains("alphaCutoff"))
+        {
+            material.alphaCutoff = MATERIAL.at("alphaCutoff");
+        }
+        if (MATERIAL.contains("alphaMode"))
+        {
+            material.alphaMode = ParseAlphaMode(MATERIAL.at("alphaMode").get_ref<const json::string_t&>());
+        }
+        if (MATERIAL.contains("doubleSided"))
+        {
+            material.doubleSided = MATERIAL.at("doubleSided");
+        }
+        if (MATERIAL.contains("emissiveFactor"))
+        {
+            const json &EMISSIVE_FACTOR = MATERIAL.at("emissiveFactor");
+            for (int j = 0; j < EMISSIVE_FACTOR.size(); j++)
+            {
+                material.emissiveFactor[j] = EMISSIVE_FACTOR.at(j);
+            }
+        }
+        if (MATERIAL.contains("emissiveTexture"))
+        {
+            const json &EMISSIVE_TEXTURE = MATERIAL.at("emissiveTexture");
+            int index = EMISSIVE_TEXTURE.at("index");
+            material.emissiveTexture = TextureInfo(index);
+            if (EMISSIVE_TEXTURE.contains("texCoord"))
+            {
+                int texCoord = EMISSIVE_TEXTURE.at("texCoord");
+                material.emissiveTexture.texCoord = texCoord;
+            }
+        }
+        material.name = ParseName(MATERIAL, strings);
+        if (MATERIAL.contains("normalTexture"))
+        {
+            const json &NORMAL_TEXTURE = MATERIAL.at("normalTexture");
+            int index = NORMAL_TEXTURE.at("index");
+            material.normalTexture = MaterialNormalTextureInfo(index);
+            if (NORMAL_TEXTURE.contains("texCoord"))
+            {
+                int texCoord = NORMAL_TEXTURE.at("texCoord");
+                material.normalTexture.texCoord = texCoord;
+            }
+            if (NORMAL_TEXTURE.contains("scale"))
+            {
+                float scale = NORMAL_TEXTURE.at("scale");
+                material.normalTexture.scale = scale;
+            }
+        }
+        if (MATERIAL.contains("occlusionTexture"))
+        {
+            const json &OCCLUSION_TEXTURE = MATERIAL.at("occlusionTexture");
+            int index = OCCLUSION_TEXTURE.at("index");
+            material.occlusionTexture = MaterialOcclusionTextureInfo(index);
+            if (OCCLUSION_TEXTURE.contains("strength"))
+            {
+                material.occlusionTexture.strength = OCCLUSION_TEXTURE.at("strength");
+            }
+            if (OCCLUSION_TEXTURE.contains("texCoord"))
+            {
+                material.occlusionTexture.texCoord = OCCLUSION_TEXTURE.at("texCoord");
+            }
+        }
+        if (MATERIAL.contains("pbrMetallicRoughness"))
+        {
+            const json &PBR_METALLIC_ROUGHNESS = MATERIAL.at("pbrMetallicRoughness");
+            MaterialPBRMetallicRoughness &pbrMetallicRoughness = material.pbrMetallicRoughness;
+            if (PBR_METALLIC_ROUGHNESS.contains("baseColorFactor"))
+            {
+                const json &BASE_COLOR_FACTOR = PBR_METALLIC_ROUGHNESS.at("baseColorFactor");
+                for (int j = 0; j < BASE_COLOR_FACTOR.size(); j++)
+                {
+                    pbrMetallicRoughness.baseColorFactor[j] = BASE_COLOR_FACTOR.at(j);
+                }
+            }
+            if (PBR_METALLIC_ROUGHNESS.contains("baseColorTexture"))
+            {
+                const json &BASE_COLOR_TEXTURE = PBR_METALLIC_ROUGHNESS.at("baseColorTexture");
+                int index = BASE_COLOR_TEXTURE.at("index");
+                pbrMetallicRoughness.baseColorTexture = TextureInfo(index);
+                if (BASE_COLOR_TEXTURE.contains("texCoord"))
+                {
+                    pbrMetallicRoughness.baseColorTexture.texCoord = BASE_COLOR_TEXTURE.at("texCoord");
+                }
+            }
+            if (PBR_METALLIC_ROUGHNESS.contains("metallicFactor"))
+            {
+                pbrMetallicRoughness.metallicFactor = PBR_METALLIC_ROUGHNESS.at("metallicFactor");
+            }
+            if (PBR_METALLIC_ROUGHNESS.contains("metallicRoughnessTexture"))
+            {
+                const json &METALLIC_ROUGHNESS_TEXTURE = PBR_METALLIC_ROUGHNESS.at("metallicRoughnessTexture");
+                int index = METALLIC_ROUGHNESS_TEXTURE.at("index");
+                pbrMetallicRoughness.metallicRoughnessTexture = TextureInfo(index);
+                if (METALLIC_ROUGHNESS_TEXTURE.contains("texCoord"))
+                {
+                    pbrMetallicRoughness.metallicRoughnessTexture.texCoord = METALLIC_ROUGHNESS_TEXTURE.at("texCoord");
+                }
+            }
+            if (PBR_METALLIC_ROUGHNESS.contains("roughnessFactor"))
+            {
+                pbrMetallicRoughness.roughnessFactor = PBR_METALLIC_ROUGHNESS.at("roughnessFactor");
+            }
+        }
+    }
+    void ParseMesh(const json &MESH, Mesh &mesh, StringPool &strings)
+    {
+        const json &PRIMITIVES = MESH.at("primitives");
+        mesh.primitives.reserve(PRIMITIVES.size());
+        for (const json &PRIMITIVE : PRIMITIVES)
+        {
+            mesh.primitives.emplace_back();
+            MeshPrimitive &primitive = mesh.primitives.back();
+            const json &ATTRIBUTES = PRIMITIVE.at("attributes");
+            primitive.attributes.reserve(ATTRIBUTES.size());
+            for (json::const_iterator it = ATTRIBUTES.begin(); it != ATTRIBUTES.end(); ++it)
+            {
+                primitive.attributes.emplace_back(strings.Intern(it.key()), it.value().get<int>());
+            }
+            primitive.Resolve();
+            if (PRIMITIVE.contains("targets"))
+            {
+                const json &TARGETS = PRIMITIVE.at("targets");
+                primitive.targets.resize(TARGETS.size());
+                for (size_t j = 0; j < TARGETS.size(); j++)
+                {
+                    const json &TARGET = TARGETS.at(j);
+                    primitive.targets[j].reserve(TARGET.size());
+                    for (json::const_iterator it = TARGET.begin(); it != TARGET.end(); ++it)
+                    {
+                        primitive.targets[j].emplace_back(strings.Intern(it.key()), it.value().get<int>());
+                    }
+                }
+            }
+            primitive.indices = PRIMITIVE.value("indices", -1);
+            primitive.material = PRIMITIVE.value("material", -1);
+            if (PRIMITIVE.contains("mode"))
+            {
+                primitive.mode = PRIMITIVE.at("mode");
+            }
+        }
+        mesh.name = ParseName(MESH, strings);
+        if (MESH.contains("weights"))
+        {
+            const json &WEIGHTS = MESH.at("weights");
+            mesh.weights.reserve(WEIGHTS.size());
+            for (const json &WEIGHT : WEIGHTS)
+            {
+                mesh.weights.push_back(WEIGHT.get<float>());
+            }
+        }
+    }
+    void ParseTexture(const json &TEXTURE, Texture &texture, StringPool &strings)
+    {
+        texture.name = ParseName(TEXTURE, strings);
+        texture.sampler = TEXTURE.value("sampler", -1);
+        texture.source = TEXTURE.value("source", -1);
+    }
+    void ParseImage(const json &IMAGE, Image &image, StringPool &strings)
+    {
+        image.bufferView = IMAGE.value("bufferView", -1);
+        image.mimeType = IMAGE.value("mimeType", "");
+        image.name = ParseName(IMAGE, strings);
+        if (IMAGE.contains("uri"))
+        {
+            LoadImageURI(image, IMAGE.at("uri").get_ref<const json::string_t&>());
+        }
+    }
+    void ParseSkin(const json &SKIN, Skin &skin, StringPool &strings)
+    {
+        const json &JOINTS = SKIN.at("joints");
+        skin.joints.reserve(JOINTS.size());
+        for (const json &JOINT : JOINTS)
+        {
+            skin.joints.push_back(JOINT);
+        }
+        skin.inverseBindMatrices = SKIN.value("inverseBindMatrices", -1);
+        skin.name = ParseName(SKIN, strings);
+        skin.skeleton = SKIN.value("skeleton", -1);
+    }
+    void ParseAccessor(const json &ACCESSOR, Accessor &accessor, StringPool &)
+    {
+        accessor.componentType = ACCESSOR.at("componentType");
+        accessor.count = ToSize(ACCESSOR.at("count"));
+        accessor.type = ParseAccessorType(ACCESSOR.at("type").get_ref<const json::string_t&>());
+        accessor.bufferView = ACCESSOR.value("bufferView", -1);
+        if (ACCESSOR.contains("byteOffset"))
+        {
+            accessor.byteOffset = ToSize(ACCESSOR.at("byteOffset"));
+        }
+        if (ACCESSOR.contains("normalized"))
+        {
+            accessor.normalized = ACCESSOR.at("normalized");
+        }
+        if (ACCESSOR.contains("min"))
+        {
+            const json &MIN = ACCESSOR.at("min");
+            accessor.min.reserve(MIN.size());
+            for (const json &VALUE : MIN)
+            {
+                accessor.min.push_back(VALUE);
+            }
+        }
+        if (ACCESSOR.contains("max"))
+        {
+            const json &MAX = ACCESSOR.at("max");
+            accessor.max.reserve(MAX.size());
+            for (const json &VALUE : MAX)
+            {
+                accessor.max.push_back(VALUE);
+            }
+        }
+        if (ACCESSOR.contains("sparse"))
+        {
+            const json &SPARSE = ACCESSOR.at("sparse");
+            accessor.sparse.count = ToSize(SPARSE.at("count"));
+            const json &INDICES = SPARSE.at("indices");
+            accessor.sparse.indices.bufferView = INDICES.at("bufferView");
+            accessor.sparse.indices.componentType = INDICES.at("componentType");
+            if (INDICES.contains("byteOffset"))
+            {
+                accessor.sparse.indices.byteOffset = ToSize(INDICES.at("byteOffset"));
+            }
+            const json &VALUES = SPARSE.at("values");
+            accessor.sparse.values.bufferView = VALUES.at("bufferView");
+            if (VALUES.contains("byteOffset"))
+            {
+                accessor.sparse.values.byteOffset = ToSize(VALUES.at("byteOffset"));
+            }
+        }
+    }
+    void ParseBufferView(const json &BUFFER_VIEW, BufferView &bufferView, StringPool &strings)
+    {
+        bufferView.buffer = BUFFER_VIEW.at("buffer");
+        bufferView.byteLength = ToSize(BUFFER_VIEW.at("byteLength"));
+        if (BUFFER_VIEW.contains("byteOffset"))
+        {
+            bufferView.byteOffset = ToSize(BUFFER_VIEW.at("byteOffset"));
+        }
+        bufferView.byteStride = BUFFER_VIEW.value("byteStride", -1);
+        bufferView.name = ParseName(BUFFER_VIEW, strings);
+        bufferView.target = BUFFER_VIEW.value("target", -1);
+    }
+    void ParseSampler(const json &SAMPLER, Sampler &sampler, StringPool &strings)
+    {
+        sampler.magFilter = SAMPLER.value("magFilter", -1);
+        sampler.minFilter = SAMPLER.value("minFilter", -1);
+        sampler.name = ParseName(SAMPLER, strings);
+        if (SAMPLER.contains("wrapS"))
+        {
+            sampler.wrapS = SAMPLER.at("wrapS");
+        }
+        if (SAMPLER.contains("wrapT"))
+        {
+            sampler.wrapT = SAMPLER.at("wrapT");
+        }
+    }
+    void ParseBuffer(const json &BUFFER, Buffer &buffer, StringPool &strings)
+    {
+        buffer.byteLength = ToSize(BUFFER.at("byteLength"));
+        buffer.name = ParseName(BUFFER, strings);
+        if (BUFFER.contains("uri"))
+        {
+            LoadBufferURI(buffer, BUFFER.at("uri").get_ref<const json::string_t&>());
+        }
+    }
+    glTF ParseJSON(const json &GLTF, const ParseOptions &options = ParseOptions())
+    {
+        const json &ASSET = GLTF.at("asset");
+        glTF gltf(Asset(ASSET.at("version").get<std::string>()));
+        gltf.asset.copyright = ASSET.value("copyright", "");
+        gltf.asset.generator = ASSET.value("generator", "");
+        gltf.asset.minVersion = ASSET.value("minVersion", "");
+
+        gltf.scene = GLTF.value("scene", -1);
+        std::vector<std::function<void()>> tasks;
+        AddParseTasks(tasks, GLTF, "cameras", gltf.cameras, ParseCamera, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "scenes", gltf.scenes, ParseScene, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "nodes", gltf.nodes, ParseNode, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "animations", gltf.animations, ParseAnimation, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "materials", gltf.materials, ParseMaterial, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "meshes", gltf.meshes, ParseMesh, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "textures", gltf.textures, ParseTexture, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "images", gltf.images, ParseImage, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "skins", gltf.skins, ParseSkin, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "accessors", gltf.accessors, ParseAccessor, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "bufferViews", gltf.bufferViews, ParseBufferView, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "samplers", gltf.samplers, ParseSampler, *gltf.strings, options.chunkSize);
+        AddParseTasks(tasks, GLTF, "buffers", gltf.buffers, ParseBuffer, *gltf.strings, options.chunkSize);
+        RunTasks(tasks, options.threads);
+        Validate(gltf);
+        return gltf;
+    }
+    glTF Parse(const std::string &gltfText, const ParseOptions &options = ParseOptions())
+    {
+        return ParseJSON(json::parse(gltfText), options);
+    }
+    uint32_t ReadU32LE(const unsigned char *p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+    glTF ParseGLB(const void *data, size_t size, const ParseOptions &options = ParseOptions())
+    {
+        const uint32_t GLB_MAGIC = 0x46546C67;
+        const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+        const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+        const unsigned char *bytes = (const unsigned char*)data;
+        if (!bytes || size < 20)
+        {
+            throw std::runtime_error("glb: file too small");
+        }
+        if (ReadU32LE(bytes) != GLB_MAGIC)
+        {
+            throw std::runtime_error("glb: bad magic");
+        }
+        if (ReadU32LE(bytes + 4) != 2)
+        {
+            throw std::runtime_error("glb: unsupported version");
+        }
+        uint32_t length = ReadU32LE(bytes + 8);
+        if (length > size || length < 20)
+        {
+            throw std::runtime_error("glb: bad length");
+        }
+
+        const unsigned char *jsonChunk = nullptr;
+        uint32_t jsonLength = 0;
+        const unsigned char *binChunk = nullptr;
+        uint32_t binLength = 0;
+        size_t offset = 12;
+        while (offset + 8 <= length)
+        {
+            uint32_t chunkLength = ReadU32LE(bytes + offset);
+            uint32_t chunkType = ReadU32LE(bytes + offset + 4);
+            offset += 8;
+            if (chunkLength > length - offset)
+            {
+                throw std::runtime_error("glb: chunk exceeds file length");
+            }
+            if (chunkType == GLB_CHUNK_JSON && !jsonChunk)
+            {
+                jsonChunk = bytes + offset;
+                jsonLength = chunkLength;
+            }
+            else if (chunkType == GLB_CHUNK_BIN && jsonChunk && !binChunk)
+            {
+                binChunk = bytes + offset;
+                binLength = chunkLength;
+            }
+            offset += (chunkLength + 3) & ~(size_t)3;
+        }
+        if (!jsonChunk)
+        {
+            throw std::runtime_error("glb: missing JSON chunk");
+        }
+
+        glTF gltf = ParseJSON(json::parse(jsonChunk, jsonChunk + jsonLength), options);
+        if (binChunk && gltf.buffers.size() && gltf.buffers[0].uri.empty() && !gltf.buffers[0].data)
+        {
+            if (gltf.buffers[0].byteLength > binLength)
+            {
+                throw std::runtime_error("glb: BIN chunk smaller than buffer 0");
+            }
+            gltf.buffers[0].data = binChunk;
+        }
+        return gltf;
+    }
+    struct SaxFrame
+    {
+        std::string key;
+        int index = -1;
+        bool array = false;
+        const char *const *required = nullptr;
+        uint32_t requiredCount = 0;
+        uint32_t seen = 0;
+
+        SaxFrame() = default;
+        SaxFrame(bool _array) : array(_array){}
+    };
+    class SaxHandler
+    {
+    public:
+        glTF gltf;
+
+        SaxHandler()
+        {
+            gltf.scene = -1;
+        }
+        bool null()
+        {
+            Next();
+            return true;
+        }
+        bool boolean(bool val)
+        {
+            Next();
+            exact = false;
+            Number(val ? 1 : 0);
+            return true;
+        }
+        bool number_integer(json::number_integer_t val)
+        {
+            Next();
+            exact = false;
+            Number((double)val);
+            return true;
+        }
+        bool number_unsigned(json::number_unsigned_t val)
+        {
+            Next();
+            exact = true;
+            unsignedValue = val;
+            Number((double)val);
+            return true;
+        }
+        bool number_float(json::number_float_t val, const json::string_t &)
+        {
+            Next();
+            exact = false;
+            Number(val);
+            return true;
+        }
+        bool string(json::string_t &val)
+        {
+            Next();
+            String(val);
+            return true;
+        }
+        bool binary(json::binary_t &)
+        {
+            Next();
+            return true;
+        }
+        bool start_object(std::size_t)
+        {
+            Next();
+            Begin();
+            path.push_back(SaxFrame(false));
+            RequireKeys();
+            return true;
+        }
+        bool key(json::string_t &val)
+        {
+            SaxFrame &frame = path.back();
+            frame.key = val;
+            for (uint32_t k = 0; k < frame.requiredCount; k++)
+            {
+                if (val == frame.required[k])
+                {
+                    frame.seen |= 1u << k;
+                }
+            }
+            return true;
+        }
+        bool end_object()
+        {
+            const SaxFrame &frame = path.back();
+            for (uint32_t k = 0; k < frame.requiredCount; k++)
+            {
+                if (!(frame.seen & (1u << k)))
+                {
+                    throw json::out_of_range::create(403, std::string("key '") + frame.required[k] + "' not found", nullptr);
+                }
+            }
+            path.pop_back();
+            return true;
+        }
+        bool start_array(std::size_t)
+        {
+            Next();
+            path.push_back(SaxFrame(true));
+            return true;
+        }
+        bool end_array()
+        {
+            path.pop_back();
+            return true;
+        }
+        template<class Exception>
+        bool parse_error(std::size_t, const std::string &, const Exception &ex)
+        {
+            throw ex;
+        }
+
+    private:
+        std::vector<SaxFrame> path;
+        uint64_t unsignedValue = 0;
+        bool exact = false;
+
+        uint64_t Size(double v) const
+        {
+            return exact ? unsignedValue : ToSize(v);
+        }
+
+        void Next()
+        {
+            if (path.size() && path.back().array)
+            {
+                path.back().index++;
+            }
+        }
+        bool Is(size_t depth, const char *key) const
+        {
+            return !path[depth].array && path[depth].key == key;
+        }
+        bool Element(size_t depth) const
+        {
+            return path[depth].array && path[depth].index >= 0;
+        }
+        template<size_t N>
+        void Require(const char *const (&keys)[N])
+        {
+            path.back().required = keys;
+            path.back().requiredCount = (uint32_t)N;
+        }
+        void RequireKeys()
+        {
+            static const char *const ROOT[] = {"asset"};
+            static const char *const ASSET[] = {"version"};
+            static const char *const CAMERA[] = {"type"};
+            static const char *const ORTHOGRAPHIC[] = {"xmag", "ymag", "zfar", "znear"};
+            static const char *const PERSPECTIVE[] = {"yfov", "znear"};
+            static const char *const ANIMATION[] = {"channels", "samplers"};
+            static const char *const CHANNEL[] = {"target", "sampler"};
+            static const char *const TARGET[] = {"path"};
+            static const char *const ANIMATION_SAMPLER[] = {"input", "output"};
+            static const char *const MESH[] = {"primitives"};
+            static const char *const PRIMITIVE[] = {"attributes"};
+            static const char *const SKIN[] = {"joints"};
+            static const char *const ACCESSOR[] = {"componentType", "count", "type"};
+            static const char *const SPARSE[] = {"count", "indices", "values"};
+            static const char *const SPARSE_INDICES[] = {"bufferView", "componentType"};
+            static const char *const SPARSE_VALUES[] = {"bufferView"};
+            static const char *const BUFFER_VIEW[] = {"buffer", "byteLength"};
+            static const char *const BUFFER[] = {"byteLength"};
+            size_t d = path.size() - 1;
+            if (d == 0)
+            {
+                Require(ROOT);
+                return;
+            }
+            if (d == 1)
+            {
+                if (Is(0, "asset")) Require(ASSET);
+                return;
+            }
+            if (!Element(1))
+            {
+                return;
+            }
+            const std::string &section = path[0].key;
+            if (d == 2)
+            {
+                if (section == "cameras") Require(CAMERA);
+                else if (section == "animations") Require(ANIMATION);
+                else if (section == "meshes") Require(MESH);
+                else if (section == "skins") Require(SKIN);
+                else if (section == "accessors") Require(ACCESSOR);
+                else if (section == "bufferViews") Require(BUFFER_VIEW);
+                else if (section == "buffers") Require(BUFFER);
+            }
+            else if (d == 3)
+            {
+                if (section == "cameras" && Is(2, "orthographic")) Require(ORTHOGRAPHIC);
+                else if (section == "cameras" && Is(2, "perspective")) Require(PERSPECTIVE);
+                else if (section == "accessors" && Is(2, "sparse")) Require(SPARSE);
+            }
+            else if (d == 4 && Element(3))
+            {
+                if (section == "animations" && Is(2, "channels")) Require(CHANNEL);
+                else if (section == "animations" && Is(2, "samplers")) Require(ANIMATION_SAMPLER);
+                else if (section == "meshes" && Is(2, "primitives")) Require(PRIMITIVE);
+            }
+            else if (d == 4 && section == "accessors" && Is(2, "sparse"))
+            {
+                if (Is(3, "indices")) Require(SPARSE_INDICES);
+                else if (Is(3, "values")) Require(SPARSE_VALUES);
+            }
+            else if (d == 5 && Element(3) && section == "animations" && Is(2, "channels") && Is(4, "target"))
+            {
+                Require(TARGET);
+            }
+        }
+        void Begin()
+        {
+            size_t d = path.size();
+            if (d == 2 && Element(1))
+            {
+                const std::string &section = path[0].key;
+                if (section == "cameras") gltf.cameras.emplace_back();
+                else if (section == "scenes") gltf.scenes.emplace_back();
+                else if (section == "nodes") gltf.nodes.emplace_back();
+                else if (section == "animations") gltf.animations.emplace_back();
+                else if (section == "materials") gltf.materials.emplace_back();
+                else if (section == "meshes") gltf.meshes.emplace_back();
+                else if (section == "textures") gltf.textures.emplace_back();
+                else if (section == "images") gltf.images.emplace_back();
+                else if (section == "skins") gltf.skins.emplace_back();
+                else if (section == "accessors") gltf.accessors.emplace_back();
+                else if (section == "bufferViews") gltf.bufferViews.emplace_back();
+                else if (section == "samplers") gltf.samplers.emplace_back();
+                else if (section == "buffers") gltf.buffers.emplace_back();
+            }
+            else if (d == 4 && Element(1) && Element(3))
+            {
+                if (Is(0, "animations") && Is(2, "channels"))
+                {
+                    gltf.animations.back().channels.emplace_back();
+                }
+                else if (Is(0, "animations") && Is(2, "samplers"))
+                {
+                    gltf.animations.back().samplers.emplace_back();
+                }
+                else if (Is(0, "meshes") && Is(2, "primitives"))
+                {
+                    gltf.meshes.back().primitives.emplace_back();
+                }
+            }
+            else if (d == 6 && Element(1) && Element(3) && Element(5) && Is(0, "meshes") && Is(2, "primitives") && Is(4, "targets"))
+            {
+                gltf.meshes.back().primitives.back().targets.emplace_back();
+            }
+        }
+        void SetAttribute(Vector<std::pair<Name, int>> &attributes, const std::string &key, int id)
+        {
+            std::pair<Name, int> attribute(gltf.strings->Intern(key), id);
+            Vector<std::pair<Name, int>>::iterator it = std::lower_bound(attributes.begin(), attributes.end(), attribute, [](const std::pair<Name, int> &a, const std::pair<Name, int> &b)
+            {
+                return a.first < b.first;
+            });
+            if (it != attributes.end() && it->first == attribute.first)
+            {
+                it->second = id;
+            }
+            else
+            {
+                attributes.insert(it, attribute);
+            }
+        }
+        void Number(double v)
+        {
+            size_t d = path.size();
+            if (d == 1)
+            {
+                if (Is(0, "scene"))
+                {
+                    gltf.scene = (int)v;
+                }
+                return;
+            }
+            if (d < 3 || !Element(1))
+            {
+                return;
+            }
+            const std::string &section = path[0].key;
+            const std::string &key = path[2].key;
+            size_t i = (size_t)path[1].index;
+            if (d == 3)
+            {
+                if (section == "nodes" && i < gltf.nodes.size())
+                {
+                    Node &node = gltf.nodes[i];
+                    if (key == "camera") node.camera = (int)v;
+                    else if (key == "mesh") node.mesh = (int)v;
+                    else if (key == "skin") node.skin = (int)v;
+                }
+                else if (section == "accessors" && i < gltf.accessors.size())
+                {
+                    Accessor &accessor = gltf.accessors[i];
+                    if (key == "bufferView") accessor.bufferView = (int)v;
+                    else if (key == "byteOffset") accessor.byteOffset = Size(v);
+                    else if (key == "componentType") accessor.componentType = (int)v;
+                    else if (key == "normalized") accessor.normalized = v != 0;
+                    else if (key == "count") accessor.count = Size(v);
+                }
+                else if (section == "bufferViews" && i < gltf.bufferViews.size())
+                {
+                    BufferView &bufferView = gltf.bufferViews[i];
+                    if (key == "buffer") bufferView.buffer = (int)v;
+                    else if (key == "byteOffset") bufferView.byteOffset = Size(v);
+                    else if (key == "byteLength") bufferView.byteLength = Size(v);
+                    else if (key == "byteStride") bufferView.byteStride = (int)v;
+                    else if (key == "target") bufferView.target = (int)v;
+                }
+                else if (section == "buffers" && i < gltf.buffers.size())
+                {
+                    if (key == "byteLength") gltf.buffers[i].byteLength = Size(v);
+                }
+                else if (section == "materials" && i < gltf.materials.size())
+                {
+                    Material &material = gltf.materials[i];
+                    if (key == "alphaCutoff") material.alphaCutoff = (float)v;
+                    else if (key == "doubleSided") material.doubleSided = v != 0;
+                }
+                else if (section == "textures" && i < gltf.textures.size())
+                {
+                    Texture &texture = gltf.textures[i];
+                    if (key == "sampler") texture.sampler = (int)v;
+                    else if (key == "source") texture.source = (int)v;
+                }
+                else if (section == "images" && i < gltf.images.size())
+                {
+                    if (key == "bufferView") gltf.images[i].bufferView = (int)v;
+                }
+                else if (section == "skins" && i < gltf.skins.size())
+                {
+                    Skin &skin = gltf.skins[i];
+                    if (key == "inverseBindMatrices") skin.inverseBindMatrices = (int)v;
+                    else if (key == "skeleton") skin.skeleton = (int)v;
+                }
+                else if (section == "samplers" && i < gltf.samplers.size())
+                {
+                    Sampler &sampler = gltf.samplers[i];
+                    if (key == "magFilter") sampler.magFilter = (int)v;
+                    else if (key == "minFilter") sampler.minFilter = (int)v;
+                    else if (key == "wrapS") sampler.wrapS = (int)v;
+                    else if (key == "wrapT") sampler.wrapT = (int)v;
+                }
+                return;
+            }
+            if (d == 4 && Element(3))
+            {
+                size_t j = (size_t)path[3].index;
+                if (section == "nodes" && i < gltf.nodes.size())
+                {
+                    Node &node = gltf.nodes[i];
+                    if (key == "children") node.children.push_back((int)v);
+                    else if (key == "matrix" && j < 16) node.matrix[j] = (float)v;
+                    else if (key == "rotation" && j < 4) node.rotation[j] = (float)v;
+                    else if (key == "scale" && j < 3) node.scale[j] = (float)v;
+                    else if (key == "translation" && j < 3) node.translation[j] = (float)v;
+                }
+                else if (section == "scenes" && i < gltf.scenes.size())
+                {
+                    if (key == "nodes") gltf.scenes[i].nodes.push_back((int)v);
+                }
+                else if (section == "accessors" && i < gltf.accessors.size())
+                {
+                    if (key == "min") gltf.accessors[i].min.push_back((float)v);
+                    else if (key == "max") gltf.accessors[i].max.push_back((float)v);
+                }
+                else if (section == "skins" && i < gltf.skins.size())
+                {
+                    if (key == "joints") gltf.skins[i].joints.push_back((int)v);
+                }
+                else if (section == "meshes" && i < gltf.meshes.size())
+                {
+                    if (key == "weights") gltf.meshes[i].weights.push_back((float)v);
+                }
+                else if (section == "materials" && i < gltf.materials.size())
+                {
+                    if (key == "emissiveFactor" && j < 3) gltf.materials[i].emissiveFactor[j] = (float)v;
+                }
+                return;
+            }
+            if (d >= 4 && section == "accessors" && key == "sparse" && i < gltf.accessors.size())
+            {
+                AccessorSparse &sparse = gltf.accessors[i].sparse;
+                const std::string &field = path[3].key;
+                if (d == 4 && field == "count") sparse.count = Size(v);
+                else if (d == 5 && field == "indices" && Is(4, "bufferView")) sparse.indices.bufferView = (int)v;
+                else if (d == 5 && field == "indices" && Is(4, "byteOffset")) sparse.indices.byteOffset = Size(v);
+                else if (d == 5 && field == "indices" && Is(4, "componentType")) sparse.indices.componentType = (int)v;
+                else if (d == 5 && field == "values" && Is(4, "bufferView")) sparse.values.bufferView = (int)v;
+                else if (d == 5 && field == "values" && Is(4, "byteOffset")) sparse.values.byteOffset = Size(v);
+                return;
+            }
+            if (d == 4 && section == "cameras" && i < gltf.cameras.size())
+            {
+                Camera &camera = gltf.cameras[i];
+                const std::string &field = path[3].key;
+                if (key == "orthographic")
+                {
+                    if (field == "xmag") camera.orthographic.xmag = (float)v;
+                    else if (field == "ymag") camera.orthographic.ymag = (float)v;
+                    else if (field == "zfar") camera.orthographic.zfar = (float)v;
+                    else if (field == "znear") camera.orthographic.znear = (float)v;
+                }
+                else if (key == "perspective")
+                {
+                    if (field == "aspectRatio") camera.perspective.aspectRatio = (float)v;
+                    else if (field == "yfov") camera.perspective.yfov = (float)v;
+                    else if (field == "zfar") camera.perspective.zfar = (float)v;
+                    else if (field == "znear") camera.perspective.znear = (float)v;
+                }
+                return;
+            }
+            if (d == 4 && section == "materials" && i < gltf.materials.size())
+            {
+                Material &material = gltf.materials[i];
+                const std::string &field = path[3].key;
+                if (key == "emissiveTexture")
+                {
+                    if (field == "index") material.emissiveTexture.index = (int)v;
+                    else if (field == "texCoord") material.emissiveTexture.texCoord = (int)v;
+                }
+                else if (key == "normalTexture")
+                {
+                    if (field == "index") material.normalTexture.index = (int)v;
+                    else if (field == "texCoord") material.normalTexture.texCoord = (int)v;
+                    else if (field == "scale") material.normalTexture.scale = (float)v;
+                }
+                else if (key == "occlusionTexture")
+                {
+                    if (field == "index") material.occlusionTexture.index = (int)v;
+                    else if (field == "texCoord") material.occlusionTexture.texCoord = (int)v;
+                    else if (field == "strength") material.occlusionTexture.strength = (float)v;
+                }
+                else if (key == "pbrMetallicRoughness")
+                {
+                    if (field == "metallicFactor") material.pbrMetallicRoughness.metallicFactor = (float)v;
+                    else if (field == "roughnessFactor") material.pbrMetallicRoughness.roughnessFactor = (float)v;
+                }
+                return;
+            }
+            if (d == 5 && section == "materials" && Is(2, "pbrMetallicRoughness") && i < gltf.materials.size())
+            {
+                MaterialPBRMetallicRoughness &pbr = gltf.materials[i].pbrMetallicRoughness;
+                const std::string &field = path[3].key;
+                if (field == "baseColorFactor" && Element(4) && path[4].index < 4)
+                {
+                    pbr.baseColorFactor[path[4].index] = (float)v;
+                }
+                else if (field == "baseColorTexture" && Is(4, "index")) pbr.baseColorTexture.index = (int)v;
+                else if (field == "baseColorTexture" && Is(4, "texCoord")) pbr.baseColorTexture.texCoord = (int)v;
+                else if (field == "metallicRoughnessTexture" && Is(4, "index")) pbr.metallicRoughnessTexture.index = (int)v;
+                else if (field == "metallicRoughnessTexture" && Is(4, "texCoord")) pbr.metallicRoughnessTexture.texCoord = (int)v;
+                return;
+            }
+            if (d >= 5 && Element(3))
+            {
+                size_t j = (size_t)path[3].index;
+                const std::string &field = path[4].key;
+                if (section == "animations" && i < gltf.animations.size())
+                {
+                    Animation &animation = gltf.animations[i];
+                    if (key == "channels" && j < animation.channels.size())
+                    {
+                        AnimationChannel &channel = animation.channels[j];
+                        if (d == 5 && field == "sampler") channel.sampler = (int)v;
+                        else if (d == 6 && field == "target" && Is(5, "node")) channel.target.node = (int)v;
+                    }
+                    else if (key == "samplers" && j < animation.samplers.size() && d == 5)
+                    {
+                        AnimationSampler &sampler = animation.samplers[j];
+                        if (field == "input") sampler.input = (int)v;
+                        else if (field == "output") sampler.output = (int)v;
+                    }
+                }
+                else if (section == "meshes" && key == "primitives" && i < gltf.meshes.size() && j < gltf.meshes[i].primitives.size())
+                {
+                    MeshPrimitive &primitive = gltf.meshes[i].primitives[j];
+                    if (d == 5 && field == "indices") primitive.indices = (int)v;
+                    else if (d == 5 && field == "material") primitive.material = (int)v;
+                    else if (d == 5 && field == "mode") primitive.mode = (int)v;
+                    else if (d == 6 && field == "attributes" && !path[5].array)
+                    {
+                        SetAttribute(primitive.attributes, path[5].key, (int)v);
+                    }
+                    else if (d == 7 && field == "targets" && Element(5) && !path[6].array && (size_t)path[5].index < primitive.targets.size())
+                    {
+                        SetAttribute(primitive.targets[path[5].index], path[6].key, (int)v);
+                    }
+                }
+            }
+        }
+        void String(std::string &v)
+        {
+            size_t d = path.size();
+            if (d == 2 && Is(0, "asset") && !path[1].array)
+            {
+                const std::string &key = path[1].key;
+                if (key == "copyright") gltf.asset.copyright = std::move(v);
+                else if (key == "generator") gltf.asset.generator = std::move(v);
+                else if (key == "version") gltf.asset.version = std::move(v);
+                else if (key == "minVersion") gltf.asset.minVersion = std::move(v);
+                return;
+            }
+            if (d < 3 || !Element(1))
+            {
+                return;
+            }
+            const std::string &section = path[0].key;
+            const std::string &key = path[2].key;
+            size_t i = (size_t)path[1].index;
+            if (d == 3)
+            {
+                if (key == "name")
+                {
+                    Name name = gltf.strings->Intern(v);
+                    if (section == "cameras" && i < gltf.cameras.size()) gltf.cameras[i].name = name;
+                    else if (section == "scenes" && i < gltf.scenes.size()) gltf.scenes[i].name = name;
+                    else if (section == "nodes" && i < gltf.nodes.size()) gltf.nodes[i].name = name;
+                    else if (section == "animations" && i < gltf.animations.size()) gltf.animations[i].name = name;
+                    else if (section == "materials" && i < gltf.materials.size()) gltf.materials[i].name = name;
+                    else if (section == "meshes" && i < gltf.meshes.size()) gltf.meshes[i].name = name;
+                    else if (section == "textures" && i < gltf.textures.size()) gltf.textures[i].name = name;
+                    else if (section == "images" && i < gltf.images.size()) gltf.images[i].name = name;
+                    else if (section == "skins" && i < gltf.skins.size()) gltf.skins[i].name = name;
+                    else if (section == "bufferViews" && i < gltf.bufferViews.size()) gltf.bufferViews[i].name = name;
+                    else if (section == "samplers" && i < gltf.samplers.size()) gltf.samplers[i].name = name;
+                    else if (section == "buffers" && i < gltf.buffers.size()) gltf.buffers[i].name = name;
+                }
+                else if (section == "accessors" && key == "type" && i < gltf.accessors.size()) gltf.accessors[i].type = ParseAccessorType(v);
+                else if (section == "materials" && key == "alphaMode" && i < gltf.materials.size()) gltf.materials[i].alphaMode = ParseAlphaMode(v);
+                else if (section == "cameras" && key == "type" && i < gltf.cameras.size()) gltf.cameras[i].type = ParseCameraType(v);
+                else if (section == "images" && key == "uri" && i < gltf.images.size())
+                {
+                    LoadImageURI(gltf.images[i], v);
+                    std::string().swap(v);
+                }
+                else if (section == "images" && key == "mimeType" && i < gltf.images.size()) gltf.images[i].mimeType = std::move(v);
+                else if (section == "buffers" && key == "uri" && i < gltf.buffers.size())
+                {
+                    LoadBufferURI(gltf.buffers[i], v);
+                    std::string().swap(v);
+                }
+                return;
+            }
+            if (section == "animations" && d >= 5 && Element(3) && i < gltf.animations.size())
+            {
+                Animation &animation = gltf.animations[i];
+                size_t j = (size_t)path[3].index;
+                const std::string &field = path[4].key;
+                if (d == 5 && key == "samplers" && field == "interpolation" && j < animation.samplers.size())
+                {
+                    animation.samplers[j].interpolation = ParseInterpolation(v);
+                }
+                else if (d == 6 && key == "channels" && field == "target" && Is(5, "path") && j < animation.channels.size())
+                {
+                    AnimationChannelTarget &target = animation.channels[j].target;
+                    target.path = ParseAnimationPath(v);
+                    if (target.path == AnimationPath::UNKNOWN)
+                    {
+                        target.customPath = gltf.strings->Intern(v);
+                    }
+                }
+            }
+        }
+    };
+    glTF ParseStreaming(const std::string &gltfText)
+    {
+        SaxHandler handler;
+        json::sax_parse(gltfText, &handler);
+        for (Mesh &mesh : handler.gltf.meshes)
+        {
+            for (MeshPrimitive &primitive : mesh.primitives)
+            {
+                primitive.Resolve();
+            }
+        }
+        Validate(handler.gltf);
+        return std::move(handler.gltf);
+    }
+    struct AccessResult
+    {
+        const Accessor* accessor;
+        const BufferView* bufferView;
+        const Buffer* buffer;
+    };
+    AccessResult Access(const glTF &gltf, int accessorId)
+    {
+        AccessResult result;
+        result.accessor = &(gltf.accessors[accessorId]);
+        result.bufferView = &(gltf.bufferViews[result.accessor->bufferView]);
+        result.buffer = &(gltf.buffers[result.bufferView->buffer]);
+
+        return result;
+    }
+    struct ByteSpan
+    {
+        std::shared_ptr<const void> owner;
+        const unsigned char *data = nullptr;
+        size_t size = 0;
+
+        ByteSpan() = default;
+        ByteSpan(const std::shared_ptr<const void> &_owner, const unsigned char *_data, size_t _size) : owner(_owner), data(_data), size(_size){}
+
+        ByteSpan Sub(uint64_t offset, uint64_t length) const
+        {
+            if (offset > size || length > size - offset)
+            {
+                throw std::out_of_range("gltf: span range exceeds buffer");
+            }
+            return ByteSpan(owner, data + offset, (size_t)length);
+        }
+    };
+    template<typename T>
+    class AccessorView
+    {
+    public:
+        class Iterator
+        {
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef const T& reference;
+
+            Iterator() = default;
+            Iterator(const unsigned char *_ptr, size_t _stride) : ptr(_ptr), stride(_stride){}
+
+            reference operator*() const { return *(const T*)ptr; }
+            pointer operator->() const { return (const T*)ptr; }
+            reference operator[](difference_type n) const { return *(const T*)(ptr + n * (difference_type)stride); }
+            Iterator &operator++() { ptr += stride; return *this; }
+            Iterator operator++(int) { Iterator it = *this; ptr += stride; return it; }
+            Iterator &operator--() { ptr -= stride; return *this; }
+            Iterator operator--(int) { Iterator it = *this; ptr -= stride; return it; }
+            Iterator &operator+=(difference_type n) { ptr += n * (difference_type)stride; return *this; }
+            Iterator &operator-=(difference_type n) { ptr -= n * (difference_type)stride; return *this; }
+            Iterator operator+(difference_type n) const { return Iterator(ptr + n * (difference_type)stride, stride); }
+            Iterator operator-(difference_type n) const { return Iterator(ptr - n * (difference_type)stride, stride); }
+            difference_type operator-(const Iterator &other) const { return (ptr - other.ptr) / (difference_type)stride; }
+            bool operator==(const Iterator &other) const { return ptr == other.ptr; }
+            bool operator!=(const Iterator &other) const { return ptr != other.ptr; }
+            bool operator<(const Iterator &other) const { return ptr < other.ptr; }
+            bool operator>(const Iterator &other) const { return ptr > other.ptr; }
+            bool operator<=(const Iterator &other) const { return ptr <= other.ptr; }
+            bool operator>=(const Iterator &other) const { return ptr >= other.ptr; }
+
+        private:
+            const unsigned char *ptr = nullptr;
+            size_t stride = sizeof(T);
+        };
+
+        AccessorView() = default;
+        AccessorView(const ByteSpan &_span, size_t _stride, size_t _count) : span(_span), stride(_stride), count(_count){}
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        Iterator begin() const { return Iterator(span.data, stride); }
+        Iterator end() const { return Iterator(span.data + count * stride, stride); }
+        const T &operator[](size_t i) const { return *(const T*)(span.data + i * stride); }
+
+        bool Contiguous() const
+        {
+            return stride == sizeof(T);
+        }
+        const T *Data() const
+        {
+            return Contiguous() ? (const T*)span.data : nullptr;
+        }
+        size_t Stride() const
+        {
+            return stride;
+        }
+        void CopyTo(T *out) const
+        {
+            if (Contiguous())
+            {
+                std::memcpy(out, span.data, count * sizeof(T));
+                return;
+            }
+            const unsigned char *src = span.data;
+            for (size_t i = 0; i < count; i++, src += stride)
+            {
+                std::memcpy(out + i, src, sizeof(T));
+            }
+        }
+
+    private:
+        ByteSpan span;
+        size_t stride = sizeof(T);
+        size_t count = 0;
+    };
+    template<typename T>
+    class SparseAccessorView
+    {
+    public:
+        class Iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef T value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const T* pointer;
+            typedef T reference;
+
+            Iterator() = default;
+            Iterator(const SparseAccessorView *_view, size_t _index, size_t _cursor) : view(_view), index(_index), cursor(_cursor){}
+
+            T operator*() const
+            {
+                if (cursor < view->indices.size() && view->indices[cursor] == index)
+                {
+                    return view->values[cursor];
+                }
+                return view->Base(index);
+            }
+            Iterator &operator++()
+            {
+                if (cursor < view->indices.size() && view->indices[cursor] == index)
+                {
+                    cursor++;
+                }
+                index++;
+                return *this;
+            }
+            Iterator operator++(int) { Iterator it = *this; ++*this; return it; }
+            bool operator==(const Iterator &other) const { return index == other.index; }
+            bool operator!=(const Iterator &other) const { return index != other.index; }
+
+        private:
+            const SparseAccessorView *view = nullptr;
+            size_t index = 0;
+            size_t cursor = 0;
+        };
+
+        SparseAccessorView() = default;
+        SparseAccessorView(const AccessorView<T> &_base, size_t _count, std::vector<uint32_t> _indices, const AccessorView<T> &_values) : base(_base), count(_count), indices(std::move(_indices)), values(_values){}
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        Iterator begin() const { return Iterator(this, 0, 0); }
+        Iterator end() const { return Iterator(this, count, indices.size()); }
+        T operator[](size_t i) const
+        {
+            std::vector<uint32_t>::const_iterator found = std::lower_bound(indices.begin(), indices.end(), (uint32_t)i);
+            if (found != indices.end() && *found == i)
+            {
+                return values[found - indices.begin()];
+            }
+            return Base(i);
+        }
+        void CopyTo(T *out) const
+        {
+            if (base.empty())
+            {
+                std::fill(out, out + count, T());
+            }
+            else
+            {
+                base.CopyTo(out);
+            }
+            for (size_t k = 0; k < indices.size(); k++)
+            {
+                out[indices[k]] = values[k];
+            }
+        }
+
+    private:
+        AccessorView<T> base;
+        size_t count = 0;
+        std::vector<uint32_t> indices;
+        AccessorView<T> values;
+
+        T Base(size_t i) const
+        {
+            return base.empty() ? T() : base[i];
+        }
+    };
+    void ConvertU8ToFloat(const unsigned char *src, size_t n, bool isSigned, float scale, float lo, float *out)
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256 vscale = _mm256_set1_ps(scale);
+        const __m256 vlo = _mm256_set1_ps(lo);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i x = _mm_loadl_epi64((const __m128i*)(src + i));
+            __m256i w = isSigned ? _mm256_cvtepi8_epi32(x) : _mm256_cvtepu8_epi32(x);
+            _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(w), vscale), vlo));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 vlo = _mm_set1_ps(lo);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+            __m128i h[2];
+            h[0] = isSigned ? _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8) : _mm_unpacklo_epi8(x, zero);
+            h[1] = isSigned ? _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8) : _mm_unpackhi_epi8(x, zero);
+            for (int k = 0; k < 2; k++)
+            {
+                __m128i w0 = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(h[k], h[k]), 16) : _mm_unpacklo_epi16(h[k], zero);
+                __m128i w1 = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(h[k], h[k]), 16) : _mm_unpackhi_epi16(h[k], zero);
+                _mm_storeu_ps(out + i + k * 8, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(w0), vscale), vlo));
+                _mm_storeu_ps(out + i + k * 8 + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(w1), vscale), vlo));
+            }
+        }
+#elif defined(__ARM_NEON)
+        const float32x4_t vlo = vdupq_n_f32(lo);
+        for (; i + 8 <= n; i += 8)
+        {
+            float32x4_t f0, f1;
+            if (isSigned)
+            {
+                int16x8_t h = vmovl_s8(vld1_s8((const int8_t*)(src + i)));
+                f0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(h)));
+                f1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(h)));
+            }
+            else
+            {
+                uint16x8_t h = vmovl_u8(vld1_u8(src + i));
+                f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(h)));
+                f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(h)));
+            }
+            vst1q_f32(out + i, vmaxq_f32(vmulq_n_f32(f0, scale), vlo));
+            vst1q_f32(out + i + 4, vmaxq_f32(vmulq_n_f32(f1, scale), vlo));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            float f = isSigned ? (float)(signed char)src[i] : (float)src[i];
+            out[i] = std::max(f * scale, lo);
+        }
+    }
+    void ConvertU16ToFloat(const unsigned char *src, size_t n, bool isSigned, float scale, float lo, float *out)
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        const __m256 vscale = _mm256_set1_ps(scale);
+        const __m256 vlo = _mm256_set1_ps(lo);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(src + i * 2));
+            __m256i w = isSigned ? _mm256_cvtepi16_epi32(x) : _mm256_cvtepu16_epi32(x);
+            _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(w), vscale), vlo));
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        const __m128 vscale = _mm_set1_ps(scale);
+        const __m128 vlo = _mm_set1_ps(lo);
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128i h = _mm_loadu_si128((const __m128i*)(src + i * 2));
+            __m128i w0 = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(h, h), 16) : _mm_unpacklo_epi16(h, zero);
+            __m128i w1 = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(h, h), 16) : _mm_unpackhi_epi16(h, zero);
+            _mm_storeu_ps(out + i, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(w0), vscale), vlo));
+            _mm_storeu_ps(out + i + 4, _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(w1), vscale), vlo));
+        }
+#elif defined(__ARM_NEON)
+        const float32x4_t vlo = vdupq_n_f32(lo);
+        for (; i + 8 <= n; i += 8)
+        {
+            float32x4_t f0, f1;
+            if (isSigned)
+            {
+                int16x8_t h = vreinterpretq_s16_u8(vld1q_u8(src + i * 2));
+                f0 = vcvtq_f32_s32(vmovl_s16(vget_low_s16(h)));
+                f1 = vcvtq_f32_s32(vmovl_s16(vget_high_s16(h)));
+            }
+            else
+            {
+                uint16x8_t h = vreinterpretq_u16_u8(vld1q_u8(src + i * 2));
+                f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(h)));
+                f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(h)));
+            }
+            vst1q_f32(out + i, vmaxq_f32(vmulq_n_f32(f0, scale), vlo));
+            vst1q_f32(out + i + 4, vmaxq_f32(vmulq_n_f32(f1, scale), vlo));
+        }
+#endif
+        for (; i < n; i++)
+        {
+            uint16_t u;
+            std::memcpy(&u, src + i * 2, 2);
+            float f = isSigned ? (float)(int16_t)u : (float)u;
+            out[i] = std::max(f * scale, lo);
+        }
+    }
+    void ConvertComponentsToFloat(const unsigned char *src, size_t n, int componentType, bool normalized, float *out)
+    {
+        const float lowest = -std::numeric_limits<float>::max();
+        switch (componentType)
+        {
+            case 5120: ConvertU8ToFloat(src, n, true, normalized ? 1.0f / 127.0f : 1.0f, normalized ? -1.0f : lowest, out); break;
+            case 5121: ConvertU8ToFloat(src, n, false, normalized ? 1.0f / 255.0f : 1.0f, lowest, out); break;
+            case 5122: ConvertU16ToFloat(src, n, true, normalized ? 1.0f / 32767.0f : 1.0f, normalized ? -1.0f : lowest, out); break;
+            case 5123: ConvertU16ToFloat(src, n, false, normalized ? 1.0f / 65535.0f : 1.0f, lowest, out); break;
+            case 5125:
+                for (size_t i = 0; i < n; i++)
+                {
+                    uint32_t u;
+                    std::memcpy(&u, src + i * 4, 4);
+                    out[i] = (float)u;
+                }
+                break;
+            case 5126: std::memcpy(out, src, n * sizeof(float)); break;
+            default: throw std::invalid_argument("gltf: unknown componentType " + std::to_string(componentType));
+        }
+    }
+    void ConvertToFloat(const unsigned char *src, size_t stride, size_t count, int componentType, int components, bool normalized, float *out)
+    {
+        size_t elementSize = (size_t)ComponentSize(componentType) * components;
+        if (stride == elementSize)
+        {
+            ConvertComponentsToFloat(src, count * components, componentType, normalized, out);
+            return;
+        }
+        for (size_t i = 0; i < count; i++)
+        {
+            ConvertComponentsToFloat(src + i * stride, components, componentType, normalized, out + i * components);
+        }
+    }
+    void ConvertElementsToFloat(const unsigned char *src, size_t stride, size_t count, const Accessor &accessor, bool normalized, float *out)
+    {
+        int columns = PaddedColumns(accessor);
+        if (!columns)
+        {
+            ConvertToFloat(src, stride, count, accessor.componentType, ComponentCount(accessor.type), normalized, out);
+            return;
+        }
+        size_t columnSize = (size_t)ElementSize(accessor) / columns;
+        size_t components = (size_t)columns * columns;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (int c = 0; c < columns; c++)
+            {
+                ConvertComponentsToFloat(src + i * stride + c * columnSize, columns, accessor.componentType, normalized, out + i * components + c * columns);
+            }
+        }
+    }
+    class MappedFile
+    {
+    public:
+        const unsigned char *data = nullptr;
+        size_t size = 0;
+
+        MappedFile(const std::string &path)
+        {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                throw std::runtime_error("gltf: can't open " + path);
+            }
+            LARGE_INTEGER fileSize;
+            GetFileSizeEx(file, &fileSize);
+            size = (size_t)fileSize.QuadPart;
+            if (size)
+            {
+                mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+                data = mapping ? (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+                if (!data)
+                {
+                    Close();
+                    throw std::runtime_error("gltf: can't map " + path);
+                }
+            }
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                throw std::runtime_error("gltf: can't open " + path);
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0)
+            {
+                close(fd);
+                throw std::runtime_error("gltf: can't stat " + path);
+            }
+            size = (size_t)st.st_size;
+            if (size)
+            {
+                void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped == MAP_FAILED)
+                {
+                    close(fd);
+                    throw std::runtime_error("gltf: can't map " + path);
+                }
+                data = (const unsigned char*)mapped;
+            }
+            close(fd);
+#endif
+        }
+        ~MappedFile()
+        {
+            Close();
+        }
+        MappedFile(const MappedFile&) = delete;
+        MappedFile &operator=(const MappedFile&) = delete;
+
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#endif
+        void Close()
+        {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = NULL;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (data) munmap((void*)data, size);
+#endif
+            data = nullptr;
+        }
+    };
+    std::string DecodeURI(const std::string &uri)
+    {
+        std::string decoded;
+        decoded.reserve(uri.size());
+        for (size_t i = 0; i < uri.size(); i++)
+        {
+            if (uri[i] == '%' && i + 2 < uri.size() && isxdigit((unsigned char)uri[i + 1]) && isxdigit((unsigned char)uri[i + 2]))
+            {
+                decoded.push_back((char)std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                i += 2;
+            }
+            else
+            {
+                decoded.push_back(uri[i]);
+            }
+        }
+        return decoded;
+    }
+    const uint32_t CACHE_MAGIC = 0x43544C47;
+    const uint32_t CACHE_VERSION = 5;
+    uint64_t CacheKey(const void *data, size_t size)
+    {
+        return HashBytes(data, size);
+    }
+    uint64_t CacheKey(const std::string &text)
+    {
+        return CacheKey(text.data(), text.size());
+    }
+    class CacheWriter
+    {
+    public:
+        std::vector<unsigned char> records;
+
+        void U32(uint32_t v)
+        {
+            unsigned char bytes[4] = {(unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24)};
+            records.insert(records.end(), bytes, bytes + 4);
+        }
+        void U64(uint64_t v)
+        {
+            U32((uint32_t)v);
+            U32((uint32_t)(v >> 32));
+        }
+        void I32(int v)
+        {
+            U32((uint32_t)v);
+        }
+        void F32(float v)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &v, 4);
+            U32(bits);
+        }
+        void Floats(const float *v, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                F32(v[i]);
+            }
+        }
+        void Floats(const Vector<float> &v)
+        {
+            U32((uint32_t)v.size());
+            Floats(v.data(), v.size());
+        }
+        void Bytes(const unsigned char *data, size_t size)
+        {
+            U64(size);
+            records.insert(records.end(), data, data + size);
+        }
+        void Bytes(const std::shared_ptr<const std::vector<unsigned char>> &v)
+        {
+            Bytes(v ? v->data() : nullptr, v ? v->size() : 0);
+        }
+        void Ints(const Vector<int> &v)
+        {
+            U32((uint32_t)v.size());
+            for (int i : v)
+            {
+                I32(i);
+            }
+        }
+        void String(const gltf::String &v)
+        {
+            std::map<std::string, uint32_t>::const_iterator found = stringIds.find(v);
+            if (found != stringIds.end())
+            {
+                U32(found->second);
+                return;
+            }
+            uint32_t id = (uint32_t)(stringOffsets.size() / 2);
+            stringIds.emplace(v, id);
+            stringOffsets.push_back((uint32_t)strings.size());
+            stringOffsets.push_back((uint32_t)v.size());
+            strings.insert(strings.end(), v.begin(), v.end());
+            U32(id);
+        }
+        std::vector<unsigned char> Finish(uint64_t sourceKey)
+        {
+            CacheWriter header;
+            header.U32(CACHE_MAGIC);
+            header.U32(CACHE_VERSION);
+            header.U64(sourceKey);
+            header.U32((uint32_t)(stringOffsets.size() / 2));
+            header.U32((uint32_t)strings.size());
+            header.U64(records.size());
+            for (uint32_t offset : stringOffsets)
+            {
+                header.U32(offset);
+            }
+            std::vector<unsigned char> out;
+            out.reserve(header.records.size() + strings.size() + records.size());
+            out.insert(out.end(), header.records.begin(), header.records.end());
+            out.insert(out.end(), strings.begin(), strings.end());
+            out.insert(out.end(), records.begin(), records.end());
+            return out;
+        }
+
+    private:
+        std::map<std::string, uint32_t> stringIds;
+        std::vector<uint32_t> stringOffsets;
+        std::string strings;
+    };
+    class CacheReader
+    {
+    public:
+        CacheReader(const void *data, size_t size, uint64_t sourceKey, StringPool &_strings) : p((const unsigned char*)data), end((const unsigned char*)data + size), strings(_strings)
+        {
+            if (size < 32 || ReadU32LE(p) != CACHE_MAGIC)
+            {
+                throw std::runtime_error("gltf: not a glTF cache");
+            }
+            p += 4;
+            if (U32() != CACHE_VERSION)
+            {
+                throw std::runtime_error("gltf: cache version mismatch");
+            }
+            if (U64() != sourceKey)
+            {
+                throw std::runtime_error("gltf: cache is stale");
+            }
+            stringCount = U32();
+            uint32_t stringBytes = U32();
+            uint64_t recordBytes = U64();
+            if ((uint64_t)(end - p) / 8 < stringCount)
+            {
+                throw std::runtime_error("gltf: truncated cache");
+            }
+            offsets = p;
+            p += (size_t)stringCount * 8;
+            if ((uint64_t)(end - p) < stringBytes || (uint64_t)(end - p) - stringBytes != recordBytes)
+            {
+                throw std::runtime_error("gltf: truncated cache");
+            }
+            stringData = (const char*)p;
+            stringsSize = stringBytes;
+            p += stringBytes;
+        }
+        uint32_t U32()
+        {
+            Need(4);
+            uint32_t v = ReadU32LE(p);
+            p += 4;
+            return v;
+        }
+        uint64_t U64()
+        {
+            uint64_t lo = U32();
+            return lo | ((uint64_t)U32() << 32);
+        }
+        int I32()
+        {
+            return (int)U32();
+        }
+        float F32()
+        {
+            uint32_t bits = U32();
+            float v;
+            std::memcpy(&v, &bits, 4);
+            return v;
+        }
+        void Floats(float *v, size_t n)
+        {
+            Need(n * 4);
+            for (size_t i = 0; i < n; i++)
+            {
+                v[i] = F32();
+            }
+        }
+        void Floats(Vector<float> &v)
+        {
+            v.resize(Count(4));
+            Floats(v.data(), v.size());
+        }
+        void Bytes(std::shared_ptr<const std::vector<unsigned char>> &v)
+        {
+            uint64_t size = U64();
+            if (size == 0)
+            {
+                v.reset();
+                return;
+            }
+            Need(size);
+            v = std::make_shared<std::vector<unsigned char>>(p, p + (size_t)size);
+            p += (size_t)size;
+        }
+        void Ints(Vector<int> &v)
+        {
+            v.resize(Count(4));
+            for (int &i : v)
+            {
+                i = I32();
+            }
+        }
+        void String(gltf::String &v)
+        {
+            uint32_t length;
+            const char *data = Find(length);
+            v.assign(data, length);
+        }
+        void Intern(Name &v)
+        {
+            uint32_t length;
+            const char *data = Find(length);
+            v = strings.Intern(data, length);
+        }
+        uint32_t Enum(uint32_t count)
+        {
+            uint32_t v = U32();
+            if (v >= count)
+            {
+                throw std::runtime_error("gltf: cache enum out of range");
+            }
+            return v;
+        }
+        const char *Find(uint32_t &length)
+        {
+            uint32_t id = U32();
+            if (id >= stringCount)
+            {
+                throw std::runtime_error("gltf: cache string index out of range");
+            }
+            uint32_t offset = ReadU32LE(offsets + (size_t)id * 8);
+            length = ReadU32LE(offsets + (size_t)id * 8 + 4);
+            if (offset > stringsSize || length > stringsSize - offset)
+            {
+                throw std::runtime_error("gltf: cache string out of range");
+            }
+            return stringData + offset;
+        }
+        size_t Count(size_t minRecordSize)
+        {
+            uint32_t n = U32();
+            Need((size_t)n * minRecordSize);
+            return n;
+        }
+        bool Done() const
+        {
+            return p == end;
+        }
+
+    private:
+        const unsigned char *p;
+        const unsigned char *end;
+        const unsigned char *offsets = nullptr;
+        const char *stringData = nullptr;
+        uint32_t stringCount = 0;
+        uint32_t stringsSize = 0;
+        StringPool &strings;
+
+        void Need(size_t n) const
+        {
+            if ((size_t)(end - p) < n)
+            {
+                throw std::runtime_error("gltf: truncated cache");
+            }
+        }
+    };
+    void WriteCache(CacheWriter &w, const TextureInfo &info)
+    {
+        w.I32(info.index);
+        w.I32(info.texCoord);
+    }
+    void ReadCache(CacheReader &r, TextureInfo &info)
+    {
+        info.index = r.I32();
+        info.texCoord = r.I32();
+    }
+    void WriteCache(CacheWriter &w, const Vector<std::pair<Name, int>> &attributes)
+    {
+        w.U32((uint32_t)attributes.size());
+        for (const std::pair<Name, int> &attribute : attributes)
+        {
+            w.String(attribute.first);
+            w.I32(attribute.second);
+        }
+    }
+    void ReadCache(CacheReader &r, Vector<std::pair<Name, int>> &attributes)
+    {
+        attributes.resize(r.Count(8));
+        for (std::pair<Name, int> &attribute : attributes)
+        {
+            r.Intern(attribute.first);
+            attribute.second = r.I32();
+        }
+    }
+    void WriteCache(CacheWriter &w, const Accessor &accessor)
+    {
+        w.I32(accessor.bufferView);
+        w.U64(accessor.byteOffset);
+        w.I32(accessor.componentType);
+        w.U32(accessor.normalized);
+        w.U64(accessor.count);
+        w.U32((uint32_t)accessor.type);
+        w.Floats(accessor.min);
+        w.Floats(accessor.max);
+        w.U64(accessor.sparse.count);
+        w.I32(accessor.sparse.indices.bufferView);
+        w.U64(accessor.sparse.indices.byteOffset);
+        w.I32(accessor.sparse.indices.componentType);
+        w.I32(accessor.sparse.values.bufferView);
+        w.U64(accessor.sparse.values.byteOffset);
+    }
+    void ReadCache(CacheReader &r, Accessor &accessor)
+    {
+        accessor.bufferView = r.I32();
+        accessor.byteOffset = r.U64();
+        accessor.componentType = r.I32();
+        accessor.normalized = r.U32() != 0;
+        accessor.count = r.U64();
+        accessor.type = (AccessorType)r.Enum(7);
+        r.Floats(accessor.min);
+        r.Floats(accessor.max);
+        accessor.sparse.count = r.U64();
+        accessor.sparse.indices.bufferView = r.I32();
+        accessor.sparse.indices.byteOffset = r.U64();
+        accessor.sparse.indices.componentType = r.I32();
+        accessor.sparse.values.bufferView = r.I32();
+        accessor.sparse.values.byteOffset = r.U64();
+    }
+    void WriteCache(CacheWriter &w, const Animation &animation)
+    {
+        w.U32((uint32_t)animation.channels.size());
+        for (const AnimationChannel &channel : animation.channels)
+        {
+            w.I32(channel.sampler);
+            w.I32(channel.target.node);
+            w.U32((uint32_t)channel.target.path);
+            w.String(channel.target.customPath);
+        }
+        w.U32((uint32_t)animation.samplers.size());
+        for (const AnimationSampler &sampler : animation.samplers)
+        {
+            w.I32(sampler.input);
+            w.U32((uint32_t)sampler.interpolation);
+            w.I32(sampler.output);
+        }
+        w.String(animation.name);
+    }
+    void ReadCache(CacheReader &r, Animation &animation)
+    {
+        animation.channels.resize(r.Count(16));
+        for (AnimationChannel &channel : animation.channels)
+        {
+            channel.sampler = r.I32();
+            channel.target.node = r.I32();
+            channel.target.path = (AnimationPath)r.Enum(5);
+            r.Intern(channel.target.customPath);
+        }
+        animation.samplers.resize(r.Count(12));
+        for (AnimationSampler &sampler : animation.samplers)
+        {
+            sampler.input = r.I32();
+            sampler.interpolation = (Interpolation)r.Enum(3);
+            sampler.output = r.I32();
+        }
+        r.Intern(animation.name);
+    }
+    void WriteCache(CacheWriter &w, const Buffer &buffer)
+    {
+        w.String(buffer.uri);
+        w.U64(buffer.byteLength);
+        w.String(buffer.name);
+        if (buffer.storage || !buffer.data)
+        {
+            w.Bytes(buffer.storage);
+        }
+        else
+        {
+            w.Bytes(buffer.data, (size_t)buffer.byteLength);
+        }
+    }
+    void ReadCache(CacheReader &r, Buffer &buffer)
+    {
+        r.String(buffer.uri);
+        buffer.byteLength = r.U64();
+        r.Intern(buffer.name);
+        r.Bytes(buffer.storage);
+        buffer.data = buffer.storage ? buffer.storage->data() : nullptr;
+    }
+    void WriteCache(CacheWriter &w, const BufferView &bufferView)
+    {
+        w.I32(bufferView.buffer);
+        w.U64(bufferView.byteOffset);
+        w.U64(bufferView.byteLength);
+        w.I32(bufferView.byteStride);
+        w.I32(bufferView.target);
+        w.String(bufferView.name);
+    }
+    void ReadCache(CacheReader &r, BufferView &bufferView)
+    {
+        bufferView.buffer = r.I32();
+        bufferView.byteOffset = r.U64();
+        bufferView.byteLength = r.U64();
+        bufferView.byteStride = r.I32();
+        bufferView.target = r.I32();
+        r.Intern(bufferView.name);
+    }
+    void WriteCache(CacheWriter &w, const Camera &camera)
+    {
+        w.F32(camera.orthographic.xmag);
+        w.F32(camera.orthographic.ymag);
+        w.F32(camera.orthographic.zfar);
+        w.F32(camera.orthographic.znear);
+        w.F32(camera.perspective.aspectRatio);
+        w.F32(camera.perspective.yfov);
+        w.F32(camera.perspective.zfar);
+        w.F32(camera.perspective.znear);
+        w.U32((uint32_t)camera.type);
+        w.String(camera.name);
+    }
+    void ReadCache(CacheReader &r, Camera &camera)
+    {
+        camera.orthographic.xmag = r.F32();
+        camera.orthographic.ymag = r.F32();
+        camera.orthographic.zfar = r.F32();
+        camera.orthographic.znear = r.F32();
+        camera.perspective.aspectRatio = r.F32();
+        camera.perspective.yfov = r.F32();
+        camera.perspective.zfar = r.F32();
+        camera.perspective.znear = r.F32();
+        camera.type = (CameraType)r.Enum(2);
+        r.Intern(camera.name);
+    }
+    void WriteCache(CacheWriter &w, const Image &image)
+    {
+        w.String(image.uri);
+        w.String(image.mimeType);
+        w.I32(image.bufferView);
+        w.String(image.name);
+        w.Bytes(image.storage);
+    }
+    void ReadCache(CacheReader &r, Image &image)
+    {
+        r.String(image.uri);
+        r.String(image.mimeType);
+        image.bufferView = r.I32();
+        r.Intern(image.name);
+        r.Bytes(image.storage);
+    }
+    void WriteCache(CacheWriter &w, const Material &material)
+    {
+        w.String(material.name);
+        w.Floats(material.pbrMetallicRoughness.baseColorFactor, 4);
+        WriteCache(w, material.pbrMetallicRoughness.baseColorTexture);
+        w.F32(material.pbrMetallicRoughness.metallicFactor);
+        w.F32(material.pbrMetallicRoughness.roughnessFactor);
+        WriteCache(w, material.pbrMetallicRoughness.metallicRoughnessTexture);
+        w.I32(material.normalTexture.index);
+        w.I32(material.normalTexture.texCoord);
+        w.F32(material.normalTexture.scale);
+        w.I32(material.occlusionTexture.index);
+        w.I32(material.occlusionTexture.texCoord);
+        w.F32(material.occlusionTexture.strength);
+        WriteCache(w, material.emissiveTexture);
+        w.Floats(material.emissiveFactor, 3);
+        w.U32((uint32_t)material.alphaMode);
+        w.F32(material.alphaCutoff);
+        w.U32(material.doubleSided);
+    }
+    void ReadCache(CacheReader &r, Material &material)
+    {
+        r.Intern(material.name);
+        r.Floats(material.pbrMetallicRoughness.baseColorFactor, 4);
+        ReadCache(r, material.pbrMetallicRoughness.baseColorTexture);
+        material.pbrMetallicRoughness.metallicFactor = r.F32();
+        material.pbrMetallicRoughness.roughnessFactor = r.F32();
+        ReadCache(r, material.pbrMetallicRoughness.metallicRoughnessTexture);
+        material.normalTexture.index = r.I32();
+        material.normalTexture.texCoord = r.I32();
+        material.normalTexture.scale = r.F32();
+        material.occlusionTexture.index = r.I32();
+        material.occlusionTexture.texCoord = r.I32();
+        material.occlusionTexture.strength = r.F32();
+        ReadCache(r, material.emissiveTexture);
+        r.Floats(material.emissiveFactor, 3);
+        material.alphaMode = (AlphaMode)r.Enum(3);
+        material.alphaCutoff = r.F32();
+        material.doubleSided = r.U32() != 0;
+    }
+    void WriteCache(CacheWriter &w, const Mesh &mesh)
+    {
+        w.U32((uint32_t)mesh.primitives.size());
+        for (const MeshPrimitive &primitive : mesh.primitives)
+        {
+            WriteCache(w, primitive.attributes);
+            w.U32((uint32_t)primitive.targets.size());
+            for (const Vector<std::pair<Name, int>> &target : primitive.targets)
+            {
+                WriteCache(w, target);
+            }
+            w.I32(primitive.indices);
+            w.I32(primitive.material);
+            w.I32(primitive.mode);
+        }
+        w.Floats(mesh.weights);
+        w.String(mesh.name);
+    }
+    void ReadCache(CacheReader &r, Mesh &mesh)
+    {
+        mesh.primitives.resize(r.Count(20));
+        for (MeshPrimitive &primitive : mesh.primitives)
+        {
+            ReadCache(r, primitive.attributes);
+            primitive.targets.resize(r.Count(4));
+            for (Vector<std::pair<Name, int>> &target : primitive.targets)
+            {
+                ReadCache(r, target);
+            }
+            primitive.indices = r.I32();
+            primitive.material = r.I32();
+            primitive.mode = r.I32();
+            primitive.Resolve();
+        }
+        r.Floats(mesh.weights);
+        r.Intern(mesh.name);
+    }
+    void WriteCache(CacheWriter &w, const Node &node)
+    {
+        w.I32(node.camera);
+        w.Ints(node.children);
+        w.I32(node.skin);
+        w.Floats(node.matrix, 16);
+        w.I32(node.mesh);
+        w.Floats(node.rotation, 4);
+        w.Floats(node.scale, 3);
+        w.Floats(node.translation, 3);
+        w.Floats(node.weights);
+        w.String(node.name);
+    }
+    void ReadCache(CacheReader &r, Node &node)
+    {
+        node.camera = r.I32();
+        r.Ints(node.children);
+        node.skin = r.I32();
+        r.Floats(node.matrix, 16);
+        node.mesh = r.I32();
+        r.Floats(node.rotation, 4);
+        r.Floats(node.scale, 3);
+        r.Floats(node.translation, 3);
+        r.Floats(node.weights);
+        r.Intern(node.name);
+    }
+    void WriteCache(CacheWriter &w, const Sampler &sampler)
+    {
+        w.I32(sampler.magFilter);
+        w.I32(sampler.minFilter);
+        w.I32(sampler.wrapS);
+        w.I32(sampler.wrapT);
+        w.String(sampler.name);
+    }
+    void ReadCache(CacheReader &r, Sampler &sampler)
+    {
+        sampler.magFilter = r.I32();
+        sampler.minFilter = r.I32();
+        sampler.wrapS = r.I32();
+        sampler.wrapT = r.I32();
+        r.Intern(sampler.name);
+    }
+    void WriteCache(CacheWriter &w, const Scene &scene)
+    {
+        w.Ints(scene.nodes);
+        w.String(scene.name);
+    }
+    void ReadCache(CacheReader &r, Scene &scene)
+    {
+        r.Ints(scene.nodes);
+        r.Intern(scene.name);
+    }
+    void WriteCache(CacheWriter &w, const Skin &skin)
+    {
+        w.I32(skin.inverseBindMatrices);
+        w.I32(skin.skeleton);
+        w.Ints(skin.joints);
+        w.String(skin.name);
+    }
+    void ReadCache(CacheReader &r, Skin &skin)
+    {
+        skin.inverseBindMatrices = r.I32();
+        skin.skeleton = r.I32();
+        r.Ints(skin.joints);
+        r.Intern(skin.name);
+    }
+    void WriteCache(CacheWriter &w, const Texture &texture)
+    {
+        w.I32(texture.sampler);
+        w.I32(texture.source);
+        w.String(texture.name);
+    }
+    void ReadCache(CacheReader &r, Texture &texture)
+    {
+        texture.sampler = r.I32();
+        texture.source = r.I32();
+        r.Intern(texture.name);
+    }
+    template<class T>
+    void WriteCache(CacheWriter &w, const Vector<T> &items)
+    {
+        w.U32((uint32_t)items.size());
+        for (const T &item : items)
+        {
+            WriteCache(w, item);
+        }
+    }
+    template<class T>
+    void ReadCache(CacheReader &r, Vector<T> &items)
+    {
+        items.resize(r.Count(4));
+        for (T &item : items)
+        {
+            ReadCache(r, item);
+        }
+    }
+    std::vector<unsigned char> SaveCache(const glTF &gltf, uint64_t sourceKey = 0)
+    {
+        CacheWriter w;
+        w.String(gltf.asset.copyright);
+        w.String(gltf.asset.generator);
+        w.String(gltf.asset.version);
+        w.String(gltf.asset.minVersion);
+        w.I32(gltf.scene);
+        WriteCache(w, gltf.accessors);
+        WriteCache(w, gltf.animations);
+        WriteCache(w, gltf.buffers);
+        WriteCache(w, gltf.bufferViews);
+        WriteCache(w, gltf.cameras);
+        WriteCache(w, gltf.images);
+        WriteCache(w, gltf.materials);
+        WriteCache(w, gltf.meshes);
+        WriteCache(w, gltf.nodes);
+        WriteCache(w, gltf.samplers);
+        WriteCache(w, gltf.scenes);
+        WriteCache(w, gltf.skins);
+        WriteCache(w, gltf.textures);
+        return w.Finish(sourceKey);
+    }
+    void SaveCache(const glTF &gltf, const std::string &path, uint64_t sourceKey = 0)
+    {
+        std::vector<unsigned char> bytes = SaveCache(gltf, sourceKey);
+        std::string temporary = path + ".tmp";
+        FILE *file = std::fopen(temporary.c_str(), "wb");
+        if (!file)
+        {
+            throw std::runtime_error("gltf: can't create " + temporary);
+        }
+        bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+        written = std::fclose(file) == 0 && written;
+        if (!written || std::rename(temporary.c_str(), path.c_str()) != 0)
+        {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("gltf: can't write " + path);
+        }
+    }
+    glTF LoadCache(const void *data, size_t size, uint64_t sourceKey = 0)
+    {
+        glTF gltf;
+        CacheReader r(data, size, sourceKey, *gltf.strings);
+        r.String(gltf.asset.copyright);
+        r.String(gltf.asset.generator);
+        r.String(gltf.asset.version);
+        r.String(gltf.asset.minVersion);
+        gltf.scene = r.I32();
+        ReadCache(r, gltf.accessors);
+        ReadCache(r, gltf.animations);
+        ReadCache(r, gltf.buffers);
+        ReadCache(r, gltf.bufferViews);
+        ReadCache(r, gltf.cameras);
+        ReadCache(r, gltf.images);
+        ReadCache(r, gltf.materials);
+        ReadCache(r, gltf.meshes);
+        ReadCache(r, gltf.nodes);
+        ReadCache(r, gltf.samplers);
+        ReadCache(r, gltf.scenes);
+        ReadCache(r, gltf.skins);
+        ReadCache(r, gltf.textures);
+        if (!r.Done())
+        {
+            throw std::runtime_error("gltf: trailing bytes in cache");
+        }
+        return gltf;
+    }
+    glTF LoadCache(const std::string &path, uint64_t sourceKey = 0)
+    {
+        MappedFile file(path);
+        return LoadCache(file.data, file.size, sourceKey);
+    }
+    glTF LoadCache(const char *path, uint64_t sourceKey = 0)
+    {
+        return LoadCache(std::string(path), sourceKey);
+    }
+    typedef std::function<void(const void*, size_t)> WriteCallback;
+    void WriteAll(int fd, const void *data, size_t size)
+    {
+        const char *p = (const char*)data;
+        while (size > 0)
+        {
+#ifdef _WIN32
+            int written = _write(fd, p, (unsigned int)std::min(size, (size_t)1 << 30));
+#else
+            ssize_t written = ::write(fd, p, size);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+#endif
+            if (written <= 0)
+            {
+                throw std::runtime_error("gltf: write failed");
+            }
+            p += written;
+            size -= (size_t)written;
+        }
+    }
+    class JsonWriter
+    {
+    public:
+        JsonWriter(const WriteCallback &_write) : write(_write), buffer(1 << 16){}
+
+        void BeginObject()
+        {
+            Separator();
+            Put('{');
+            comma = false;
+        }
+        void EndObject()
+        {
+            Put('}');
+            comma = true;
+        }
+        void BeginArray()
+        {
+            Separator();
+            Put('[');
+            comma = false;
+        }
+        void EndArray()
+        {
+            Put(']');
+            comma = true;
+        }
+        void Key(const char *key)
+        {
+            Value(key);
+            Put(':');
+            comma = false;
+        }
+        void Value(const char *value, size_t size)
+        {
+            Separator();
+            Put('"');
+            const char *run = value;
+            for (const char *p = value; p < value + size; p++)
+            {
+                unsigned char c = (unsigned char)*p;
+                if (c >= 0x20 && c != '"' && c != '\\')
+                {
+                    continue;
+                }
+                Raw(run, p - run);
+                run = p + 1;
+                char escape[8] = {'\\', (char)c, 0};
+                switch (c)
+                {
+                    case '"': case '\\': break;
+                    case '\b': escape[1] = 'b'; break;
+                    case '\f': escape[1] = 'f'; break;
+                    case '\n': escape[1] = 'n'; break;
+                    case '\r': escape[1] = 'r'; break;
+                    case '\t': escape[1] = 't'; break;
+                    default: std::snprintf(escape, sizeof(escape), "\\u%04x", c); break;
+                }
+                Raw(escape, std::strlen(escape));
+            }
+            Raw(run, value + size - run);
+            Put('"');
+            comma = true;
+        }
+        void Value(const char *value)
+        {
+            Value(value, std::strlen(value));
+        }
+        void Value(const String &value)
+        {
+            Value(value.data(), value.size());
+        }
+        void Value(bool value)
+        {
+            Separator();
+            value ? Raw("true", 4) : Raw("false", 5);
+            comma = true;
+        }
+        void Value(int value)
+        {
+            Value((int64_t)value);
+        }
+        void Value(int64_t value)
+        {
+            Separator();
+            char digits[24];
+            char *p = digits + sizeof(digits);
+            uint64_t magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+            do
+            {
+                *--p = (char)('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (value < 0)
+            {
+                *--p = '-';
+            }
+            Raw(p, digits + sizeof(digits) - p);
+            comma = true;
+        }
+        void Value(uint64_t value)
+        {
+            if (value > (uint64_t)std::numeric_limits<int64_t>::max())
+            {
+                throw std::out_of_range("gltf: integer too large to serialize");
+            }
+            Value((int64_t)value);
+        }
+        void Value(float value)
+        {
+            if (!std::isfinite(value))
+            {
+                throw std::invalid_argument("gltf: can't serialize non-finite number");
+            }
+            if (std::fabs(value) < 1e15f && value == (float)(int64_t)value)
+            {
+                Value((int64_t)value);
+                return;
+            }
+            Separator();
+            char digits[32];
+            int length = std::snprintf(digits, sizeof(digits), "%.7g", value);
+            if (std::strtof(digits, nullptr) != value)
+            {
+                length = std::snprintf(digits, sizeof(digits), "%.9g", value);
+            }
+            Raw(digits, length);
+            comma = true;
+        }
+        void Array(const float *values, size_t count)
+        {
+            BeginArray();
+            for (size_t i = 0; i < count; i++)
+            {
+                Value(values[i]);
+            }
+            EndArray();
+        }
+        void Array(const Vector<float> &values)
+        {
+            Array(values.data(), values.size());
+        }
+        void Array(const Vector<int> &values)
+        {
+            BeginArray();
+            for (int value : values)
+            {
+                Value(value);
+            }
+            EndArray();
+        }
+        void DataURI(const char *mimeType, const unsigned char *data, size_t size)
+        {
+            static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            Separator();
+            Raw("\"data:", 6);
+            Raw(mimeType, std::strlen(mimeType));
+            Raw(";base64,", 8);
+            char encoded[4096];
+            size_t pending = 0;
+            size_t i = 0;
+            for (; i + 3 <= size; i += 3)
+            {
+                uint32_t bits = (uint32_t)data[i] << 16 | (uint32_t)data[i + 1] << 8 | data[i + 2];
+                encoded[pending++] = alphabet[bits >> 18];
+                encoded[pending++] = alphabet[(bits >> 12) & 63];
+                encoded[pending++] = alphabet[(bits >> 6) & 63];
+                encoded[pending++] = alphabet[bits & 63];
+                if (pending == sizeof(encoded))
+                {
+                    Raw(encoded, pending);
+                    pending = 0;
+                }
+            }
+            if (i < size)
+            {
+                uint32_t bits = (uint32_t)data[i] << 16 | (i + 1 < size ? (uint32_t)data[i + 1] << 8 : 0);
+                encoded[pending++] = alphabet[bits >> 18];
+                encoded[pending++] = alphabet[(bits >> 12) & 63];
+                encoded[pending++] = i + 1 < size ? alphabet[(bits >> 6) & 63] : '=';
+                encoded[pending++] = '=';
+            }
+            Raw(encoded, pending);
+            Put('"');
+            comma = true;
+        }
+        void Raw(const char *data, size_t size)
+        {
+            if (used + size > buffer.size())
+            {
+                Flush();
+                if (size > buffer.size())
+                {
+                    write(data, size);
+                    written += size;
+                    return;
+                }
+            }
+            std::memcpy(buffer.data() + used, data, size);
+            used += size;
+        }
+        void Flush()
+        {
+            if (used)
+            {
+                write(buffer.data(), used);
+                written += used;
+                used = 0;
+            }
+        }
+        uint64_t Written() const
+        {
+            return written + used;
+        }
+
+    private:
+        WriteCallback write;
+        std::vector<char> buffer;
+        size_t used = 0;
+        uint64_t written = 0;
+        bool comma = false;
+
+        void Put(char c)
+        {
+            if (used == buffer.size())
+            {
+                Flush();
+            }
+            buffer[used++] = c;
+        }
+        void Separator()
+        {
+            if (comma)
+            {
+                Put(',');
+            }
+        }
+    };
+    void Serialize(JsonWriter &w, const char *key, const TextureInfo &info)
+    {
+        if (info.index < 0)
+        {
+            return;
+        }
+        w.Key(key);
+        w.BeginObject();
+        w.Key("index");
+        w.Value(info.index);
+        if (info.texCoord != 0)
+        {
+            w.Key("texCoord");
+            w.Value(info.texCoord);
+        }
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Name &name)
+    {
+        if (!name.empty())
+        {
+            w.Key("name");
+            w.Value(name.str());
+        }
+    }
+    void Serialize(JsonWriter &w, const Vector<std::pair<Name, int>> &attributes)
+    {
+        w.BeginObject();
+        for (const std::pair<Name, int> &attribute : attributes)
+        {
+            w.Key(attribute.first.c_str());
+            w.Value(attribute.second);
+        }
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Accessor &accessor)
+    {
+        w.BeginObject();
+        if (accessor.bufferView >= 0)
+        {
+            w.Key("bufferView");
+            w.Value(accessor.bufferView);
+        }
+        if (accessor.byteOffset)
+        {
+            w.Key("byteOffset");
+            w.Value(accessor.byteOffset);
+        }
+        w.Key("componentType");
+        w.Value(accessor.componentType);
+        if (accessor.normalized)
+        {
+            w.Key("normalized");
+            w.Value(true);
+        }
+        w.Key("count");
+        w.Value(accessor.count);
+        w.Key("type");
+        w.Value(ToString(accessor.type));
+        if (accessor.max.size())
+        {
+            w.Key("max");
+            w.Array(accessor.max);
+        }
+        if (accessor.min.size())
+        {
+            w.Key("min");
+            w.Array(accessor.min);
+        }
+        if (accessor.hasSparse())
+        {
+            const AccessorSparse &sparse = accessor.sparse;
+            w.Key("sparse");
+            w.BeginObject();
+            w.Key("count");
+            w.Value(sparse.count);
+            w.Key("indices");
+            w.BeginObject();
+            w.Key("bufferView");
+            w.Value(sparse.indices.bufferView);
+            if (sparse.indices.byteOffset)
+            {
+                w.Key("byteOffset");
+                w.Value(sparse.indices.byteOffset);
+            }
+            w.Key("componentType");
+            w.Value(sparse.indices.componentType);
+            w.EndObject();
+            w.Key("values");
+            w.BeginObject();
+            w.Key("bufferView");
+            w.Value(sparse.values.bufferView);
+            if (sparse.values.byteOffset)
+            {
+                w.Key("byteOffset");
+                w.Value(sparse.values.byteOffset);
+            }
+            w.EndObject();
+            w.EndObject();
+        }
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Animation &animation)
+    {
+        w.BeginObject();
+        w.Key("channels");
+        w.BeginArray();
+        for (const AnimationChannel &channel : animation.channels)
+        {
+            if (channel.target.path == AnimationPath::UNKNOWN && channel.target.customPath.empty())
+            {
+                throw std::invalid_argument("gltf: animation channel has no target path");
+            }
+            w.BeginObject();
+            w.Key("sampler");
+            w.Value(channel.sampler);
+            w.Key("target");
+            w.BeginObject();
+            if (channel.target.node >= 0)
+            {
+                w.Key("node");
+                w.Value(channel.target.node);
+            }
+            w.Key("path");
+            if (channel.target.path == AnimationPath::UNKNOWN)
+            {
+                w.Value(channel.target.customPath);
+            }
+            else
+            {
+                w.Value(ToString(channel.target.path));
+            }
+            w.EndObject();
+            w.EndObject();
+        }
+        w.EndArray();
+        w.Key("samplers");
+        w.BeginArray();
+        for (const AnimationSampler &sampler : animation.samplers)
+        {
+            w.BeginObject();
+            w.Key("input");
+            w.Value(sampler.input);
+            if (sampler.interpolation != Interpolation::LINEAR)
+            {
+                w.Key("interpolation");
+                w.Value(ToString(sampler.interpolation));
+            }
+            w.Key("output");
+            w.Value(sampler.output);
+            w.EndObject();
+        }
+        w.EndArray();
+        Serialize(w, animation.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Asset &asset)
+    {
+        w.BeginObject();
+        if (asset.copyright.size())
+        {
+            w.Key("copyright");
+            w.Value(asset.copyright);
+        }
+        if (asset.generator.size())
+        {
+            w.Key("generator");
+            w.Value(asset.generator);
+        }
+        w.Key("version");
+        w.Value(asset.version);
+        if (asset.minVersion.size())
+        {
+            w.Key("minVersion");
+            w.Value(asset.minVersion);
+        }
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Buffer &buffer, bool binChunk)
+    {
+        w.BeginObject();
+        if (buffer.uri.size())
+        {
+            w.Key("uri");
+            w.Value(buffer.uri);
+        }
+        else if (buffer.data && !binChunk)
+        {
+            w.Key("uri");
+            w.DataURI("application/octet-stream", buffer.data, buffer.byteLength);
+        }
+        w.Key("byteLength");
+        w.Value(buffer.byteLength);
+        Serialize(w, buffer.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const BufferView &bufferView)
+    {
+        w.BeginObject();
+        w.Key("buffer");
+        w.Value(bufferView.buffer);
+        if (bufferView.byteOffset)
+        {
+            w.Key("byteOffset");
+            w.Value(bufferView.byteOffset);
+        }
+        w.Key("byteLength");
+        w.Value(bufferView.byteLength);
+        if (bufferView.byteStride > 0)
+        {
+            w.Key("byteStride");
+            w.Value(bufferView.byteStride);
+        }
+        if (bufferView.target >= 0)
+        {
+            w.Key("target");
+            w.Value(bufferView.target);
+        }
+        Serialize(w, bufferView.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Camera &camera)
+    {
+        w.BeginObject();
+        if (camera.type == CameraType::ORTHOGRAPHIC)
+        {
+            w.Key("orthographic");
+            w.BeginObject();
+            w.Key("xmag");
+            w.Value(camera.orthographic.xmag);
+            w.Key("ymag");
+            w.Value(camera.orthographic.ymag);
+            w.Key("zfar");
+            w.Value(camera.orthographic.zfar);
+            w.Key("znear");
+            w.Value(camera.orthographic.znear);
+            w.EndObject();
+        }
+        else
+        {
+            w.Key("perspective");
+            w.BeginObject();
+            if (camera.perspective.aspectRatio > 0)
+            {
+                w.Key("aspectRatio");
+                w.Value(camera.perspective.aspectRatio);
+            }
+            w.Key("yfov");
+            w.Value(camera.perspective.yfov);
+            if (camera.perspective.zfar > 0)
+            {
+                w.Key("zfar");
+                w.Value(camera.perspective.zfar);
+            }
+            w.Key("znear");
+            w.Value(camera.perspective.znear);
+            w.EndObject();
+        }
+        w.Key("type");
+        w.Value(ToString(camera.type));
+        Serialize(w, camera.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Image &image)
+    {
+        w.BeginObject();
+        if (image.uri.size())
+        {
+            w.Key("uri");
+            w.Value(image.uri);
+        }
+        else if (image.storage)
+        {
+            w.Key("uri");
+            w.DataURI(image.mimeType.size() ? image.mimeType.c_str() : "application/octet-stream", image.storage->data(), image.storage->size());
+        }
+        if (image.mimeType.size())
+        {
+            w.Key("mimeType");
+            w.Value(image.mimeType);
+        }
+        if (image.bufferView >= 0)
+        {
+            w.Key("bufferView");
+            w.Value(image.bufferView);
+        }
+        Serialize(w, image.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Material &material)
+    {
+        const MaterialPBRMetallicRoughness &pbr = material.pbrMetallicRoughness;
+        static const float white[4] = {1, 1, 1, 1};
+        static const float black[3] = {0, 0, 0};
+        bool baseColor = !std::equal(pbr.baseColorFactor, pbr.baseColorFactor + 4, white);
+        w.BeginObject();
+        Serialize(w, material.name);
+        if (baseColor || pbr.baseColorTexture.index >= 0 || pbr.metallicFactor != 1 || pbr.roughnessFactor != 1 || pbr.metallicRoughnessTexture.index >= 0)
+        {
+            w.Key("pbrMetallicRoughness");
+            w.BeginObject();
+            if (baseColor)
+            {
+                w.Key("baseColorFactor");
+                w.Array(pbr.baseColorFactor, 4);
+            }
+            Serialize(w, "baseColorTexture", pbr.baseColorTexture);
+            if (pbr.metallicFactor != 1)
+            {
+                w.Key("metallicFactor");
+                w.Value(pbr.metallicFactor);
+            }
+            if (pbr.roughnessFactor != 1)
+            {
+                w.Key("roughnessFactor");
+                w.Value(pbr.roughnessFactor);
+            }
+            Serialize(w, "metallicRoughnessTexture", pbr.metallicRoughnessTexture);
+            w.EndObject();
+        }
+        if (material.normalTexture.index >= 0)
+        {
+            w.Key("normalTexture");
+            w.BeginObject();
+            w.Key("index");
+            w.Value(material.normalTexture.index);
+            if (material.normalTexture.texCoord != 0)
+            {
+                w.Key("texCoord");
+                w.Value(material.normalTexture.texCoord);
+            }
+            if (material.normalTexture.scale != 1)
+            {
+                w.Key("scale");
+                w.Value(material.normalTexture.scale);
+            }
+            w.EndObject();
+        }
+        if (material.occlusionTexture.index >= 0)
+        {
+            w.Key("occlusionTexture");
+            w.BeginObject();
+            w.Key("index");
+            w.Value(material.occlusionTexture.index);
+            if (material.occlusionTexture.texCoord != 0)
+            {
+                w.Key("texCoord");
+                w.Value(material.occlusionTexture.texCoord);
+            }
+            if (material.occlusionTexture.strength != 1)
+            {
+                w.Key("strength");
+                w.Value(material.occlusionTexture.strength);
+            }
+            w.EndObject();
+        }
+        Serialize(w, "emissiveTexture", material.emissiveTexture);
+        if (!std::equal(material.emissiveFactor, material.emissiveFactor + 3, black))
+        {
+            w.Key("emissiveFactor");
+            w.Array(material.emissiveFactor, 3);
+        }
+        if (material.alphaMode != AlphaMode::OPAQUE)
+        {
+            w.Key("alphaMode");
+            w.Value(ToString(material.alphaMode));
+        }
+        if (material.alphaCutoff != 0.5f)
+        {
+            w.Key("alphaCutoff");
+            w.Value(material.alphaCutoff);
+        }
+        if (material.doubleSided)
+        {
+            w.Key("doubleSided");
+            w.Value(true);
+        }
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Mesh &mesh)
+    {
+        w.BeginObject();
+        w.Key("primitives");
+        w.BeginArray();
+        for (const MeshPrimitive &primitive : mesh.primitives)
+        {
+            w.BeginObject();
+            w.Key("attributes");
+            Serialize(w, primitive.attributes);
+            if (primitive.indices >= 0)
+            {
+                w.Key("indices");
+                w.Value(primitive.indices);
+            }
+            if (primitive.material >= 0)
+            {
+                w.Key("material");
+                w.Value(primitive.material);
+            }
+            if (primitive.mode != 4)
+            {
+                w.Key("mode");
+                w.Value(primitive.mode);
+            }
+            if (primitive.targets.size())
+            {
+                w.Key("targets");
+                w.BeginArray();
+                for (const Vector<std::pair<Name, int>> &target : primitive.targets)
+                {
+                    Serialize(w, target);
+                }
+                w.EndArray();
+            }
+            w.EndObject();
+        }
+        w.EndArray();
+        if (mesh.weights.size())
+        {
+            w.Key("weights");
+            w.Array(mesh.weights);
+        }
+        Serialize(w, mesh.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Node &node)
+    {
+        static const float identity[4] = {0, 0, 0, 1};
+        static const float one[3] = {1, 1, 1};
+        w.BeginObject();
+        if (node.camera >= 0)
+        {
+            w.Key("camera");
+            w.Value(node.camera);
+        }
+        if (node.children.size())
+        {
+            w.Key("children");
+            w.Array(node.children);
+        }
+        if (node.skin >= 0)
+        {
+            w.Key("skin");
+            w.Value(node.skin);
+        }
+        if (node.hasMatrix())
+        {
+            w.Key("matrix");
+            w.Array(node.matrix, 16);
+        }
+        if (node.mesh >= 0)
+        {
+            w.Key("mesh");
+            w.Value(node.mesh);
+        }
+        if (!std::equal(node.rotation, node.rotation + 4, identity))
+        {
+            w.Key("rotation");
+            w.Array(node.rotation, 4);
+        }
+        if (!std::equal(node.scale, node.scale + 3, one))
+        {
+            w.Key("scale");
+            w.Array(node.scale, 3);
+        }
+        if (!std::equal(node.translation, node.translation + 3, identity))
+        {
+            w.Key("translation");
+            w.Array(node.translation, 3);
+        }
+        if (node.weights.size())
+        {
+            w.Key("weights");
+            w.Array(node.weights);
+        }
+        Serialize(w, node.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Sampler &sampler)
+    {
+        w.BeginObject();
+        if (sampler.magFilter >= 0)
+        {
+            w.Key("magFilter");
+            w.Value(sampler.magFilter);
+        }
+        if (sampler.minFilter >= 0)
+        {
+            w.Key("minFilter");
+            w.Value(sampler.minFilter);
+        }
+        if (sampler.wrapS != 10497)
+        {
+            w.Key("wrapS");
+            w.Value(sampler.wrapS);
+        }
+        if (sampler.wrapT != 10497)
+        {
+            w.Key("wrapT");
+            w.Value(sampler.wrapT);
+        }
+        Serialize(w, sampler.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Scene &scene)
+    {
+        w.BeginObject();
+        if (scene.nodes.size())
+        {
+            w.Key("nodes");
+            w.Array(scene.nodes);
+        }
+        Serialize(w, scene.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Skin &skin)
+    {
+        w.BeginObject();
+        if (skin.inverseBindMatrices >= 0)
+        {
+            w.Key("inverseBindMatrices");
+            w.Value(skin.inverseBindMatrices);
+        }
+        if (skin.skeleton >= 0)
+        {
+            w.Key("skeleton");
+            w.Value(skin.skeleton);
+        }
+        w.Key("joints");
+        w.Array(skin.joints);
+        Serialize(w, skin.name);
+        w.EndObject();
+    }
+    void Serialize(JsonWriter &w, const Texture &texture)
+    {
+        w.BeginObject();
+        if (texture.sampler >= 0)
+        {
+            w.Key("sampler");
+            w.Value(texture.sampler);
+        }
+        if (texture.source >= 0)
+        {
+            w.Key("source");
+            w.Value(texture.source);
+        }
+        Serialize(w, texture.name);
+        w.EndObject();
+    }
+    template <typename T>
+    void Serialize(JsonWriter &w, const char *key, const Vector<T> &items)
+    {
+        if (items.empty())
+        {
+            return;
+        }
+        w.Key(key);
+        w.BeginArray();
+        for (const T &item : items)
+        {
+            Serialize(w, item);
+        }
+        w.EndArray();
+    }
+    void Serialize(JsonWriter &w, const glTF &gltf, int binBuffer)
+    {
+        w.BeginObject();
+        w.Key("asset");
+        Serialize(w, gltf.asset);
+        if (gltf.scene >= 0)
+        {
+            w.Key("scene");
+            w.Value(gltf.scene);
+        }
+        Serialize(w, "scenes", gltf.scenes);
+        Serialize(w, "nodes", gltf.nodes);
+        Serialize(w, "cameras", gltf.cameras);
+        Serialize(w, "meshes", gltf.meshes);
+        Serialize(w, "skins", gltf.skins);
+        Serialize(w, "animations", gltf.animations);
+        Serialize(w, "materials", gltf.materials);
+        Serialize(w, "textures", gltf.textures);
+        Serialize(w, "images", gltf.images);
+        Serialize(w, "samplers", gltf.samplers);
+        Serialize(w, "accessors", gltf.accessors);
+        Serialize(w, "bufferViews", gltf.bufferViews);
+        if (gltf.buffers.size())
+        {
+            w.Key("buffers");
+            w.BeginArray();
+            for (size_t i = 0; i < gltf.buffers.size(); i++)
+            {
+                Serialize(w, gltf.buffers[i], (int)i == binBuffer);
+            }
+            w.EndArray();
+        }
+        w.EndObject();
+        w.Flush();
+    }
+    void Serialize(const glTF &gltf, const WriteCallback &write)
+    {
+        JsonWriter w(write);
+        Serialize(w, gltf, -1);
+    }
+    void Serialize(const glTF &gltf, int fd)
+    {
+        Serialize(gltf, [fd](const void *data, size_t size)
+        {
+            WriteAll(fd, data, size);
+        });
+    }
+    std::string Serialize(const glTF &gltf)
+    {
+        std::string text;
+        Serialize(gltf, [&text](const void *data, size_t size)
+        {
+            text.append((const char*)data, size);
+        });
+        return text;
+    }
+    void SerializeGLB(const glTF &gltf, const WriteCallback &write)
+    {
+        const uint32_t GLB_MAGIC = 0x46546C67;
+        const uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+        const uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+        int binBuffer = gltf.buffers.size() && gltf.buffers[0].uri.empty() && gltf.buffers[0].data ? 0 : -1;
+        uint64_t jsonLength = 0;
+        {
+            JsonWriter counter([&jsonLength](const void*, size_t size)
+            {
+                jsonLength += size;
+            });
+            Serialize(counter, gltf, binBuffer);
+        }
+        uint64_t jsonPadded = (jsonLength + 3) & ~(uint64_t)3;
+        uint64_t binLength = binBuffer >= 0 ? gltf.buffers[0].byteLength : 0;
+        uint64_t binPadded = (binLength + 3) & ~(uint64_t)3;
+        uint64_t length = 12 + 8 + jsonPadded + (binBuffer >= 0 ? 8 + binPadded : 0);
+        if (length > 0xFFFFFFFFu)
+        {
+            throw std::length_error("glb: output exceeds 4 GiB");
+        }
+
+        unsigned char header[20];
+        uint32_t fields[5] = {GLB_MAGIC, 2, (uint32_t)length, (uint32_t)jsonPadded, GLB_CHUNK_JSON};
+        for (int i = 0; i < 5; i++)
+        {
+            for (int j = 0; j < 4; j++)
+            {
+                header[i * 4 + j] = (unsigned char)(fields[i] >> (j * 8));
+            }
+        }
+        write(header, 20);
+        JsonWriter w(write);
+        Serialize(w, gltf, binBuffer);
+        if (w.Written() != jsonLength)
+        {
+            throw std::logic_error("glb: JSON chunk changed while writing");
+        }
+        const unsigned char padding[4] = {' ', ' ', ' ', ' '};
+        write(padding, jsonPadded - jsonLength);
+        if (binBuffer >= 0)
+        {
+            const unsigned char zeros[4] = {0, 0, 0, 0};
+            for (int j = 0; j < 4; j++)
+            {
+                header[j] = (unsigned char)(binPadded >> (j * 8));
+                header[4 + j] = (unsigned char)(GLB_CHUNK_BIN >> (j * 8));
+            }
+            write(header, 8);
+            write(gltf.buffers[0].data, binLength);
+            write(zeros, binPadded - binLength);
+        }
+    }
+    void SerializeGLB(const glTF &gltf, int fd)
+    {
+        SerializeGLB(gltf, [fd](const void *data, size_t size)
+        {
+            WriteAll(fd, data, size);
+        });
+    }
+    class AssetLoader
+    {
+    public:
+        AssetLoader(const glTF &_gltf, const std::string &_dir) : gltf(&_gltf), dir(_dir), buffers(_gltf.buffers.size()){}
+
+        void Reset()
+        {
+            buffers.assign(gltf->buffers.size(), ByteSpan());
+        }
+        ByteSpan BufferSpan(int bufferId)
+        {
+            if (bufferId >= 0 && (size_t)bufferId >= buffers.size() && (size_t)bufferId < gltf->buffers.size())
+            {
+                buffers.resize(gltf->buffers.size());
+            }
+            ByteSpan &span = buffers.at(bufferId);
+            if (span.data)
+            {
+                return span;
+            }
+            const Buffer &buffer = gltf->buffers[bufferId];
+            if (buffer.data)
+            {
+                span = ByteSpan(buffer.storage, buffer.data, (size_t)buffer.byteLength);
+                return span;
+            }
+            if (buffer.uri.empty())
+            {
+                throw std::runtime_error("gltf: buffer " + std::to_string(bufferId) + " has no data");
+            }
+            std::shared_ptr<MappedFile> &file = files[buffer.uri];
+            if (!file)
+            {
+                file = std::make_shared<MappedFile>(dir + DecodeURI(buffer.uri));
+            }
+            if (buffer.byteLength > file->size)
+            {
+                throw std::out_of_range("gltf: " + buffer.uri + " is smaller than byteLength");
+            }
+            span = ByteSpan(std::shared_ptr<const void>(file, file->data), file->data, (size_t)buffer.byteLength);
+            return span;
+        }
+        ByteSpan BufferViewSpan(int bufferViewId)
+        {
+            const BufferView &bufferView = gltf->bufferViews.at(bufferViewId);
+            return BufferSpan(bufferView.buffer).Sub(bufferView.byteOffset, bufferView.byteLength);
+        }
+        ByteSpan AccessorSpan(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            if (accessor.bufferView < 0 || accessor.count == 0)
+            {
+                return ByteSpan();
+            }
+            const BufferView &bufferView = gltf->bufferViews.at(accessor.bufferView);
+            return BufferViewSpan(accessor.bufferView).Sub(accessor.byteOffset, AccessorByteLength(accessor, bufferView));
+        }
+        template<typename T>
+        AccessorView<T> View(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            if (accessor.hasSparse())
+            {
+                throw std::logic_error("gltf: accessor " + std::to_string(accessorId) + " is sparse, use SparseView");
+            }
+            return BaseView<T>(accessor, accessorId);
+        }
+        template<typename T>
+        SparseAccessorView<T> SparseView(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            AccessorView<T> base = BaseView<T>(accessor, accessorId);
+            if (!accessor.hasSparse())
+            {
+                return SparseAccessorView<T>(base, (size_t)accessor.count, std::vector<uint32_t>(), AccessorView<T>());
+            }
+            ByteSpan values = SparseValuesSpan(accessor);
+            return SparseAccessorView<T>(base, (size_t)accessor.count, ReadSparseIndices(accessor), AccessorView<T>(values, sizeof(T), (size_t)accessor.sparse.count));
+        }
+        std::vector<uint32_t> ReadSparseIndices(const Accessor &accessor)
+        {
+            const AccessorSparseIndices &sparseIndices = accessor.sparse.indices;
+            size_t count = (size_t)accessor.sparse.count;
+            int componentSize = ComponentSize(sparseIndices.componentType);
+            ByteSpan span = BufferViewSpan(sparseIndices.bufferView).Sub(sparseIndices.byteOffset, CheckedMul(count, componentSize));
+            std::vector<uint32_t> indices(count);
+            for (size_t k = 0; k < count; k++)
+            {
+                const unsigned char *p = span.data + k * componentSize;
+                if (componentSize == 1)
+                {
+                    indices[k] = p[0];
+                }
+                else if (componentSize == 2)
+                {
+                    uint16_t u;
+                    std::memcpy(&u, p, 2);
+                    indices[k] = u;
+                }
+                else
+                {
+                    std::memcpy(&indices[k], p, 4);
+                }
+                if (indices[k] >= accessor.count || (k && indices[k] <= indices[k - 1]))
+                {
+                    throw std::out_of_range("gltf: sparse indices must be increasing and within count");
+                }
+            }
+            return indices;
+        }
+        void ReadAsFloat(int accessorId, float *out)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            int components = ComponentCount(accessor.type);
+            if (accessor.count == 0)
+            {
+                return;
+            }
+            if (accessor.bufferView < 0)
+            {
+                std::fill(out, out + (size_t)accessor.count * components, 0.0f);
+            }
+            else
+            {
+                const BufferView &bufferView = gltf->bufferViews.at(accessor.bufferView);
+                ByteSpan span = AccessorSpan(accessorId);
+                ConvertElementsToFloat(span.data, (size_t)ElementStride(accessor, bufferView), (size_t)accessor.count, accessor, accessor.normalized, out);
+            }
+            if (accessor.hasSparse())
+            {
+                Densify(accessor, components, out);
+            }
+        }
+        std::vector<float> ReadAsFloat(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            std::vector<float> out((size_t)accessor.count * ComponentCount(accessor.type));
+            ReadAsFloat(accessorId, out.data());
+            return out;
+        }
+        std::vector<unsigned char> ReadElements(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            size_t elementSize = (size_t)ElementSize(accessor);
+            std::vector<unsigned char> out((size_t)CheckedMul(accessor.count, elementSize));
+            if (accessor.count == 0)
+            {
+                return out;
+            }
+            if (accessor.bufferView >= 0)
+            {
+                const BufferView &bufferView = gltf->bufferViews.at(accessor.bufferView);
+                ByteSpan span = AccessorSpan(accessorId);
+                size_t stride = (size_t)ElementStride(accessor, bufferView);
+                if (stride == elementSize)
+                {
+                    std::memcpy(out.data(), span.data, out.size());
+                }
+                else
+                {
+                    for (size_t i = 0; i < (size_t)accessor.count; i++)
+                    {
+                        std::memcpy(&out[i * elementSize], span.data + i * stride, elementSize);
+                    }
+                }
+            }
+            if (accessor.hasSparse())
+            {
+                std::vector<uint32_t> indices = ReadSparseIndices(accessor);
+                const unsigned char *values = SparseValuesSpan(accessor).data;
+                for (size_t k = 0; k < indices.size(); k++)
+                {
+                    std::memcpy(&out[(size_t)indices[k] * elementSize], values + k * elementSize, elementSize);
+                }
+            }
+            return out;
+        }
+        std::vector<uint32_t> ReadIndices(int accessorId)
+        {
+            const Accessor &accessor = gltf->accessors.at(accessorId);
+            if (accessor.type != AccessorType::SCALAR || (accessor.componentType != 5121 && accessor.componentType != 5123 && accessor.componentType != 5125))
+            {
+                throw std::invalid_argument("gltf: accessor " + std::to_string(accessorId) + " is not an index accessor");
+            }
+            std::vector<unsigned char> elements = ReadElements(accessorId);
+            std::vector<uint32_t> indices((size_t)accessor.count);
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                if (accessor.componentType == 5121)
+                {
+                    indices[i] = elements[i];
+                }
+                else if (accessor.componentType == 5123)
+                {
+                    uint16_t u;
+                    std::memcpy(&u, &elements[i * 2], 2);
+                    indices[i] = u;
+                }
+                else
+                {
+                    std::memcpy(&indices[i], &elements[i * 4], 4);
+                }
+            }
+            return indices;
+        }
+
+    private:
+        const glTF *gltf;
+        std::string dir;
+        std::vector<ByteSpan> buffers;
+        std::map<std::string, std::shared_ptr<MappedFile>> files;
+
+        template<typename T>
+        AccessorView<T> BaseView(const Accessor &accessor, int accessorId)
+        {
+            if (sizeof(T) != ElementSize(accessor))
+            {
+                throw std::invalid_argument("gltf: view type size doesn't match accessor element size");
+            }
+            if (accessor.bufferView < 0 || accessor.count == 0)
+            {
+                return AccessorView<T>();
+            }
+            const BufferView &bufferView = gltf->bufferViews.at(accessor.bufferView);
+            return AccessorView<T>(AccessorSpan(accessorId), (size_t)ElementStride(accessor, bufferView), (size_t)accessor.count);
+        }
+        ByteSpan SparseValuesSpan(const Accessor &accessor)
+        {
+            const AccessorSparseValues &sparseValues = accessor.sparse.values;
+            return BufferViewSpan(sparseValues.bufferView).Sub(sparseValues.byteOffset, CheckedMul(accessor.sparse.count, ElementSize(accessor)));
+        }
+        void Densify(const Accessor &accessor, int components, float *out)
+        {
+            std::vector<uint32_t> indices = ReadSparseIndices(accessor);
+            std::vector<float> values(indices.size() * components);
+            ConvertElementsToFloat(SparseValuesSpan(accessor).data, (size_t)ElementSize(accessor), indices.size(), accessor, accessor.normalized, values.data());
+            for (size_t k = 0; k < indices.size(); k++)
+            {
+                std::memcpy(out + (size_t)indices[k] * components, &values[k * components], components * sizeof(float));
+            }
+        }
+    };
+    void ComputeLocalMatrix(const Node &node, float *out)
+    {
+        if (node.hasMatrix())
+        {
+            std::memcpy(out, node.matrix, 16 * sizeof(float));
+            return;
+        }
+        const float *q = node.rotation;
+        const float *s = node.scale;
+        float xx = q[0] * q[0], yy = q[1] * q[1], zz = q[2] * q[2];
+        float xy = q[0] * q[1], xz = q[0] * q[2], yz = q[1] * q[2];
+        float wx = q[3] * q[0], wy = q[3] * q[1], wz = q[3] * q[2];
+        out[0] = (1 - 2 * (yy + zz)) * s[0];
+        out[1] = 2 * (xy + wz) * s[0];
+        out[2] = 2 * (xz - wy) * s[0];
+        out[3] = 0;
+        out[4] = 2 * (xy - wz) * s[1];
+        out[5] = (1 - 2 * (xx + zz)) * s[1];
+        out[6] = 2 * (yz + wx) * s[1];
+        out[7] = 0;
+        out[8] = 2 * (xz + wy) * s[2];
+        out[9] = 2 * (yz - wx) * s[2];
+        out[10] = (1 - 2 * (xx + yy)) * s[2];
+        out[11] = 0;
+        out[12] = node.translation[0];
+        out[13] = node.translation[1];
+        out[14] = node.translation[2];
+        out[15] = 1;
+    }
+    void MultiplyMatrix(const float *a, const float *b, float *out)
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        __m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+        __m128 r[4];
+        for (int j = 0; j < 4; j++)
+        {
+            const float *c = b + j * 4;
+            r[j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(c[0])), _mm_mul_ps(a1, _mm_set1_ps(c[1]))), _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(c[2])), _mm_mul_ps(a3, _mm_set1_ps(c[3]))));
+        }
+        for (int j = 0; j < 4; j++)
+        {
+            _mm_storeu_ps(out + j * 4, r[j]);
+        }
+#elif defined(__ARM_NEON)
+        float32x4_t a0 = vld1q_f32(a), a1 = vld1q_f32(a + 4), a2 = vld1q_f32(a + 8), a3 = vld1q_f32(a + 12);
+        float32x4_t r[4];
+        for (int j = 0; j < 4; j++)
+        {
+            float32x4_t c = vld1q_f32(b + j * 4);
+            r[j] = vmulq_lane_f32(a0, vget_low_f32(c), 0);
+            r[j] = vmlaq_lane_f32(r[j], a1, vget_low_f32(c), 1);
+            r[j] = vmlaq_lane_f32(r[j], a2, vget_high_f32(c), 0);
+            r[j] = vmlaq_lane_f32(r[j], a3, vget_high_f32(c), 1);
+        }
+        for (int j = 0; j < 4; j++)
+        {
+            vst1q_f32(out + j * 4, r[j]);
+        }
+#else
+        float r[16];
+        for (int j = 0; j < 4; j++)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                r[j * 4 + i] = a[i] * b[j * 4] + a[4 + i] * b[j * 4 + 1] + a[8 + i] * b[j * 4 + 2] + a[12 + i] * b[j * 4 + 3];
+            }
+        }
+        std::memcpy(out, r, sizeof(r));
+#endif
+    }
+    struct TransformTable
+    {
+        std::vector<int> nodes;
+        std::vector<int> parents;
+        std::vector<size_t> levels;
+        std::vector<int> entries;
+        std::vector<float> local;
+        std::vector<float> world;
+
+        size_t size() const
+        {
+            return nodes.size();
+        }
+        const float *World(int node) const
+        {
+            int entry = entries.at(node);
+            return entry >= 0 ? &world[(size_t)entry * 16] : nullptr;
+        }
+        void UpdateLocal(const glTF &gltf)
+        {
+            for (size_t i = 0; i < nodes.size(); i++)
+            {
+                ComputeLocalMatrix(gltf.nodes[nodes[i]], &local[i * 16]);
+            }
+        }
+        void UpdateWorld(int threads = 1, size_t chunkSize = 4096)
+        {
+            chunkSize = std::max(chunkSize, (size_t)1);
+            for (size_t level = 0; level + 1 < levels.size(); level++)
+            {
+                size_t begin = levels[level];
+                size_t end = levels[level + 1];
+                if (threads == 1 || end - begin <= chunkSize)
+                {
+                    UpdateWorld(begin, end);
+                    continue;
+                }
+                std::vector<std::function<void()>> tasks;
+                for (size_t chunk = begin; chunk < end; chunk += chunkSize)
+                {
+                    size_t chunkEnd = std::min(chunk + chunkSize, end);
+                    tasks.push_back([this, chunk, chunkEnd]()
+                    {
+                        UpdateWorld(chunk, chunkEnd);
+                    });
+                }
+                RunTasks(tasks, threads);
+            }
+        }
+
+    private:
+        void UpdateWorld(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (parents[i] < 0)
+                {
+                    std::memcpy(&world[i * 16], &local[i * 16], 16 * sizeof(float));
+                }
+                else
+                {
+                    MultiplyMatrix(&world[(size_t)parents[i] * 16], &local[i * 16], &world[i * 16]);
+                }
+            }
+        }
+    };
+    TransformTable BuildTransformTable(const glTF &gltf, int scene = -1)
+    {
+        TransformTable table;
+        table.entries.assign(gltf.nodes.size(), -1);
+        std::vector<int> roots;
+        if (scene >= 0)
+        {
+            const Vector<int> &nodes = gltf.scenes.at(scene).nodes;
+            roots.assign(nodes.begin(), nodes.end());
+        }
+        else
+        {
+            std::vector<char> isChild(gltf.nodes.size(), 0);
+            for (const Node &node : gltf.nodes)
+            {
+                for (int child : node.children)
+                {
+                    if (child >= 0 && child < (int)isChild.size())
+                    {
+                        isChild[child] = 1;
+                    }
+                }
+            }
+            for (size_t i = 0; i < gltf.nodes.size(); i++)
+            {
+                if (!isChild[i])
+                {
+                    roots.push_back((int)i);
+                }
+            }
+        }
+        table.nodes.reserve(gltf.nodes.size());
+        table.parents.reserve(gltf.nodes.size());
+        for (int root : roots)
+        {
+            if (root < 0 || root >= (int)gltf.nodes.size() || table.entries[root] >= 0)
+            {
+                throw std::out_of_range("gltf: invalid or repeated scene root " + std::to_string(root));
+            }
+            table.entries[root] = (int)table.nodes.size();
+            table.nodes.push_back(root);
+            table.parents.push_back(-1);
+        }
+        size_t begin = 0;
+        while (begin < table.nodes.size())
+        {
+            size_t end = table.nodes.size();
+            table.levels.push_back(begin);
+            for (size_t i = begin; i < end; i++)
+            {
+                for (int child : gltf.nodes[table.nodes[i]].children)
+                {
+                    if (child < 0 || child >= (int)gltf.nodes.size() || table.entries[child] >= 0)
+                    {
+                        throw std::out_of_range("gltf: node " + std::to_string(child) + " is not part of a strict tree");
+                    }
+                    table.entries[child] = (int)table.nodes.size();
+                    table.nodes.push_back(child);
+                    table.parents.push_back((int)i);
+                }
+            }
+            begin = end;
+        }
+        table.levels.push_back(table.nodes.size());
+        table.local.resize(table.nodes.size() * 16);
+        table.world.resize(table.nodes.size() * 16);
+        table.UpdateLocal(gltf);
+        return table;
+    }
+    void NormalizeQuaternion(float *q)
+    {
+        float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        if (length > 0)
+        {
+            float inverse = 1.0f / length;
+            q[0] *= inverse;
+            q[1] *= inverse;
+            q[2] *= inverse;
+            q[3] *= inverse;
+        }
+    }
+    void NormalizeVector(float *v)
+    {
+        float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        if (length > 0)
+        {
+            float inverse = 1.0f / length;
+            v[0] *= inverse;
+            v[1] *= inverse;
+            v[2] *= inverse;
+        }
+    }
+    void InterpolateQuaternion(const float *a, const float *b, float t, bool slerp, float *out)
+    {
+        float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        float sign = d < 0 ? -1.0f : 1.0f;
+        d *= sign;
+        float wa = 1 - t;
+        float wb = t;
+        if (slerp && d < 0.9995f)
+        {
+            float theta = std::acos(d);
+            float inverse = 1.0f / std::sin(theta);
+            wa = std::sin(wa * theta) * inverse;
+            wb = std::sin(wb * theta) * inverse;
+        }
+        wb *= sign;
+        for (int i = 0; i < 4; i++)
+        {
+            out[i] = a[i] * wa + b[i] * wb;
+        }
+        NormalizeQuaternion(out);
+    }
+    struct AnimationTrack
+    {
+        std::vector<float> times;
+        std::vector<float> values;
+        int components = 0;
+        Interpolation interpolation = Interpolation::LINEAR;
+
+        size_t size() const
+        {
+            return times.size();
+        }
+        const float *Value(size_t key) const
+        {
+            if (interpolation == Interpolation::CUBICSPLINE)
+            {
+                return &values[(key * 3 + 1) * components];
+            }
+            return &values[key * components];
+        }
+        size_t Seek(float time, size_t cursor) const
+        {
+            if (cursor >= times.size() || time < times[cursor])
+            {
+                return std::max((size_t)(std::upper_bound(times.begin(), times.end(), time) - times.begin()), (size_t)1) - 1;
+            }
+            while (cursor + 1 < times.size() && times[cursor + 1] <= time)
+            {
+                cursor++;
+            }
+            return cursor;
+        }
+        void Sample(float time, size_t key, bool rotation, bool slerp, float *out) const
+        {
+            if (times.empty())
+            {
+                return;
+            }
+            if (key + 1 >= times.size() || time <= times[key])
+            {
+                std::memcpy(out, Value(key), components * sizeof(float));
+                return;
+            }
+            const float *a = Value(key);
+            const float *b = Value(key + 1);
+            float delta = times[key + 1] - times[key];
+            float t = (time - times[key]) / delta;
+            if (interpolation == Interpolation::STEP)
+            {
+                std::memcpy(out, a, components * sizeof(float));
+            }
+            else if (interpolation == Interpolation::CUBICSPLINE)
+            {
+                const float *outTangent = a + components;
+                const float *inTangent = b - components;
+                float t2 = t * t;
+                float t3 = t2 * t;
+                float h00 = 2 * t3 - 3 * t2 + 1;
+                float h10 = (t3 - 2 * t2 + t) * delta;
+                float h01 = -2 * t3 + 3 * t2;
+                float h11 = (t3 - t2) * delta;
+                for (int i = 0; i < components; i++)
+                {
+                    out[i] = h00 * a[i] + h10 * outTangent[i] + h01 * b[i] + h11 * inTangent[i];
+                }
+                if (rotation)
+                {
+                    NormalizeQuaternion(out);
+                }
+            }
+            else if (rotation)
+            {
+                InterpolateQuaternion(a, b, t, slerp, out);
+            }
+            else
+            {
+                for (int i = 0; i < components; i++)
+                {
+                    out[i] = a[i] + (b[i] - a[i]) * t;
+                }
+            }
+        }
+    };
+    class AnimationPlayer
+    {
+    public:
+        struct Channel
+        {
+            int track = -1;
+            int node = -1;
+            AnimationPath path = AnimationPath::UNKNOWN;
+            size_t cursor = 0;
+            size_t offset = 0;
+        };
+
+        std::vector<AnimationTrack> tracks;
+        std::vector<Channel> channels;
+        std::vector<float> output;
+        bool slerp = true;
+
+        AnimationPlayer(const glTF &gltf, AssetLoader &loader, int animationId)
+        {
+            const Animation &animation = gltf.animations.at(animationId);
+            tracks.resize(animation.samplers.size());
+            for (size_t i = 0; i < animation.samplers.size(); i++)
+            {
+                const AnimationSampler &sampler = animation.samplers[i];
+                AnimationTrack &track = tracks[i];
+                track.interpolation = sampler.interpolation;
+                track.times = loader.ReadAsFloat(sampler.input);
+                track.values = loader.ReadAsFloat(sampler.output);
+                size_t keys = track.times.size() * (track.interpolation == Interpolation::CUBICSPLINE ? 3 : 1);
+                track.components = keys ? (int)(track.values.size() / keys) : 0;
+                if (track.components == 0 || track.values.size() != keys * track.components)
+                {
+                    throw std::invalid_argument("gltf: animation sampler " + std::to_string(i) + " output doesn't match its input");
+                }
+                duration = std::max(duration, track.times.back());
+            }
+            channels.reserve(animation.channels.size());
+            size_t offset = 0;
+            for (const AnimationChannel &animationChannel : animation.channels)
+            {
+                Channel channel;
+                channel.track = animationChannel.sampler;
+                channel.node = animationChannel.target.node;
+                channel.path = animationChannel.target.path;
+                if (channel.track < 0 || channel.track >= (int)tracks.size() || channel.node < 0 || channel.path == AnimationPath::UNKNOWN)
+                {
+                    continue;
+                }
+                int components = tracks[channel.track].components;
+                if ((channel.path == AnimationPath::ROTATION && components != 4) || ((channel.path == AnimationPath::TRANSLATION || channel.path == AnimationPath::SCALE) && components != 3))
+                {
+                    throw std::invalid_argument(std::string("gltf: animation channel output has the wrong number of components for ") + ToString(channel.path));
+                }
+                channel.offset = offset;
+                offset += tracks[channel.track].components;
+                channels.push_back(channel);
+            }
+            output.resize(offset);
+        }
+
+        float Duration() const
+        {
+            return duration;
+        }
+        const float *Output(size_t channel) const
+        {
+            return &output[channels[channel].offset];
+        }
+        void Evaluate(float time)
+        {
+            for (Channel &channel : channels)
+            {
+                const AnimationTrack &track = tracks[channel.track];
+                channel.cursor = track.Seek(time, channel.cursor);
+                track.Sample(time, channel.cursor, channel.path == AnimationPath::ROTATION, slerp, &output[channel.offset]);
+            }
+        }
+        void Apply(glTF &gltf) const
+        {
+            for (const Channel &channel : channels)
+            {
+                Node &node = gltf.nodes.at(channel.node);
+                const float *value = &output[channel.offset];
+                int components = tracks[channel.track].components;
+                switch (channel.path)
+                {
+                    case AnimationPath::TRANSLATION: std::memcpy(node.translation, value, 3 * sizeof(float)); break;
+                    case AnimationPath::ROTATION: std::memcpy(node.rotation, value, 4 * sizeof(float)); break;
+                    case AnimationPath::SCALE: std::memcpy(node.scale, value, 3 * sizeof(float)); break;
+                    case AnimationPath::WEIGHTS: node.weights.assign(value, value + components); break;
+                    default: break;
+                }
+            }
+        }
+
+        void EvaluateBatch(const float *times, size_t count, float *out)
+        {
+            if (batchCursors.size() != channels.size() * count)
+            {
+                batchCursors.assign(channels.size() * count, 0);
+            }
+            batchKeys[0].resize(count);
+            batchKeys[1].resize(count);
+            batchWeights[0].resize(count);
+            batchWeights[1].resize(count);
+            for (size_t j = 0; j < channels.size(); j++)
+            {
+                const Channel &channel = channels[j];
+                const AnimationTrack &track = tracks[channel.track];
+                size_t *cursors = &batchCursors[j * count];
+                float *dst = out + channel.offset * count;
+                if (track.interpolation == Interpolation::CUBICSPLINE)
+                {
+                    std::vector<float> sample(track.components);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        cursors[i] = track.Seek(times[i], cursors[i]);
+                        track.Sample(times[i], cursors[i], channel.path == AnimationPath::ROTATION, slerp, sample.data());
+                        for (int c = 0; c < track.components; c++)
+                        {
+                            dst[c * count + i] = sample[c];
+                        }
+                    }
+                    continue;
+                }
+                int32_t *key0 = batchKeys[0].data();
+                int32_t *key1 = batchKeys[1].data();
+                float *wa = batchWeights[0].data();
+                float *wb = batchWeights[1].data();
+                for (size_t i = 0; i < count; i++)
+                {
+                    size_t key = track.Seek(times[i], cursors[i]);
+                    cursors[i] = key;
+                    size_t next = key;
+                    float t = 0;
+                    if (key + 1 < track.size() && times[i] > track.times[key] && track.interpolation == Interpolation::LINEAR)
+                    {
+                        next = key + 1;
+                        t = (times[i] - track.times[key]) / (track.times[next] - track.times[key]);
+                    }
+                    key0[i] = (int32_t)(key * track.components);
+                    key1[i] = (int32_t)(next * track.components);
+                    wa[i] = 1 - t;
+                    wb[i] = t;
+                }
+                if (channel.path == AnimationPath::ROTATION)
+                {
+                    const float *v = track.values.data();
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        const float *a = v + key0[i];
+                        const float *b = v + key1[i];
+                        float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+                        float sign = d < 0 ? -1.0f : 1.0f;
+                        d *= sign;
+                        if (slerp && d < 0.9995f)
+                        {
+                            float theta = std::acos(d);
+                            float inverse = 1.0f / std::sin(theta);
+                            float t = wb[i];
+                            wa[i] = std::sin((1 - t) * theta) * inverse;
+                            wb[i] = std::sin(t * theta) * inverse;
+                        }
+                        wb[i] *= sign;
+                    }
+                }
+                for (int c = 0; c < track.components; c++)
+                {
+                    BlendGather(track.values.data() + c, key0, key1, wa, wb, count, dst + c * count);
+                }
+                if (channel.path == AnimationPath::ROTATION)
+                {
+                    float *x = dst, *y = dst + count, *z = dst + 2 * count, *w = dst + 3 * count;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        float inverse = 1.0f / std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i] + w[i] * w[i]);
+                        x[i] *= inverse;
+                        y[i] *= inverse;
+                        z[i] *= inverse;
+                        w[i] *= inverse;
+                    }
+                }
+            }
+        }
+        size_t BatchSize(size_t count) const
+        {
+            return output.size() * count;
+        }
+
+    private:
+        float duration = 0;
+        std::vector<size_t> batchCursors;
+        std::vector<int32_t> batchKeys[2];
+        std::vector<float> batchWeights[2];
+
+        static void BlendGather(const float *values, const int32_t *key0, const int32_t *key1, const float *wa, const float *wb, size_t count, float *out)
+        {
+            size_t i = 0;
+#if defined(__AVX2__)
+            for (; i + 8 <= count; i += 8)
+            {
+                __m256 a = _mm256_i32gather_ps(values, _mm256_loadu_si256((const __m256i*)(key0 + i)), 4);
+                __m256 b = _mm256_i32gather_ps(values, _mm256_loadu_si256((const __m256i*)(key1 + i)), 4);
+                __m256 r = _mm256_add_ps(_mm256_mul_ps(a, _mm256_loadu_ps(wa + i)), _mm256_mul_ps(b, _mm256_loadu_ps(wb + i)));
+                _mm256_storeu_ps(out + i, r);
+            }
+#endif
+            for (; i < count; i++)
+            {
+                out[i] = values[key0[i]] * wa[i] + values[key1[i]] * wb[i];
+            }
+        }
+    };
+    void AccumulateDeltas(float *out, const float *const *deltas, const float *weights, int count, size_t size)
+    {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= size; i += 8)
+        {
+            __m256 sum = _mm256_loadu_ps(out + i);
+            for (int t = 0; t < count; t++)
+            {
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[t]), _mm256_loadu_ps(deltas[t] + i)));
+            }
+            _mm256_storeu_ps(out + i, sum);
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= size; i += 4)
+        {
+            __m128 sum = _mm_loadu_ps(out + i);
+            for (int t = 0; t < count; t++)
+            {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(deltas[t] + i)));
+            }
+            _mm_storeu_ps(out + i, sum);
+        }
+#elif defined(__ARM_NEON)
+        for (; i + 4 <= size; i += 4)
+        {
+            float32x4_t sum = vld1q_f32(out + i);
+            for (int t = 0; t < count; t++)
+            {
+                sum = vmlaq_n_f32(sum, vld1q_f32(deltas[t] + i), weights[t]);
+            }
+            vst1q_f32(out + i, sum);
+        }
+#endif
+        for (; i < size; i++)
+        {
+            float sum = out[i];
+            for (int t = 0; t < count; t++)
+            {
+                sum += weights[t] * deltas[t][i];
+            }
+            out[i] = sum;
+        }
+    }
+    struct MorphTargetSet
+    {
+        std::string attribute;
+        size_t size = 0;
+        std::vector<float> base;
+        std::vector<std::vector<float>> deltas;
+
+        void Evaluate(const float *weights, size_t weightCount, float *out, float threshold = 0.0f) const
+        {
+            std::memcpy(out, base.data(), size * sizeof(float));
+            const int BLOCK = 8;
+            const float *activeDeltas[BLOCK];
+            float activeWeights[BLOCK];
+            int active = 0;
+            size_t count = std::min(weightCount, deltas.size());
+            for (size_t t = 0; t < count; t++)
+            {
+                if (std::fabs(weights[t]) <= threshold || deltas[t].empty())
+                {
+                    continue;
+                }
+                activeDeltas[active] = deltas[t].data();
+                activeWeights[active] = weights[t];
+                if (++active == BLOCK)
+                {
+                    AccumulateDeltas(out, activeDeltas, activeWeights, active, size);
+                    active = 0;
+                }
+            }
+            if (active)
+            {
+                AccumulateDeltas(out, activeDeltas, activeWeights, active, size);
+            }
+        }
+        std::vector<float> Evaluate(const std::vector<float> &weights, float threshold = 0.0f) const
+        {
+            std::vector<float> out(size);
+            Evaluate(weights.data(), weights.size(), out.data(), threshold);
+            return out;
+        }
+    };
+    MorphTargetSet DecodeMorphTargets(AssetLoader &loader, const MeshPrimitive &primitive, const std::string &attribute)
+    {
+        MorphTargetSet set;
+        set.attribute = attribute;
+        int base = primitive.Find(attribute);
+        if (base < 0)
+        {
+            throw std::invalid_argument("gltf: primitive has no " + attribute + " attribute to morph");
+        }
+        set.base = loader.ReadAsFloat(base);
+        set.size = set.base.size();
+        set.deltas.resize(primitive.targets.size());
+        for (size_t t = 0; t < primitive.targets.size(); t++)
+        {
+            for (const std::pair<Name, int> &target : primitive.targets[t])
+            {
+                if (target.first != attribute)
+                {
+                    continue;
+                }
+                set.deltas[t] = loader.ReadAsFloat(target.second);
+                if (set.deltas[t].size() != set.size)
+                {
+                    throw std::invalid_argument("gltf: morph target " + std::to_string(t) + " " + attribute + " count doesn't match the base attribute");
+                }
+            }
+        }
+        return set;
+    }
+    enum class SkinningMethod
+    {
+        LINEAR_BLEND,
+        DUAL_QUATERNION
+    };
+    struct SkinningInput
+    {
+        size_t vertexCount = 0;
+        int influences = 0;
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> tangents;
+        std::vector<uint16_t> joints;
+        std::vector<float> weights;
+    };
+    struct SkinningOutput
+    {
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::vector<float> tangents;
+    };
+    SkinningInput DecodeSkinningInput(AssetLoader &loader, const MeshPrimitive &primitive)
+    {
+        SkinningInput input;
+        int position = primitive.Find(AttributeSemantic::POSITION);
+        if (position < 0)
+        {
+            throw std::invalid_argument("gltf: skinned primitive has no POSITION");
+        }
+        input.positions = loader.ReadAsFloat(position);
+        input.vertexCount = input.positions.size() / 3;
+        int normal = primitive.Find(AttributeSemantic::NORMAL);
+        if (normal >= 0)
+        {
+            input.normals = loader.ReadAsFloat(normal);
+        }
+        int tangent = primitive.Find(AttributeSemantic::TANGENT);
+        if (tangent >= 0)
+        {
+            input.tangents = loader.ReadAsFloat(tangent);
+        }
+        int sets = 0;
+        while (sets < MAX_ATTRIBUTE_SETS && primitive.Find(AttributeSemantic::JOINTS, sets) >= 0 && primitive.Find(AttributeSemantic::WEIGHTS, sets) >= 0)
+        {
+            sets++;
+        }
+        if (sets == 0)
+        {
+            throw std::invalid_argument("gltf: skinned primitive has no JOINTS_0/WEIGHTS_0");
+        }
+        input.influences = sets * 4;
+        input.joints.resize(input.vertexCount * input.influences);
+        input.weights.resize(input.vertexCount * input.influences);
+        for (int set = 0; set < sets; set++)
+        {
+            std::vector<float> joints = loader.ReadAsFloat(primitive.Find(AttributeSemantic::JOINTS, set));
+            std::vector<float> weights = loader.ReadAsFloat(primitive.Find(AttributeSemantic::WEIGHTS, set));
+            if (joints.size() != input.vertexCount * 4 || weights.size() != input.vertexCount * 4)
+            {
+                throw std::invalid_argument("gltf: JOINTS/WEIGHTS count doesn't match POSITION");
+            }
+            for (size_t v = 0; v < input.vertexCount; v++)
+            {
+                for (int k = 0; k < 4; k++)
+                {
+                    input.joints[v * input.influences + set * 4 + k] = (uint16_t)joints[v * 4 + k];
+                    input.weights[v * input.influences + set * 4 + k] = weights[v * 4 + k];
+                }
+            }
+        }
+        return input;
+    }
+    std::vector<float> BuildJointPalette(const glTF &gltf, AssetLoader &loader, int skinId, const TransformTable &table)
+    {
+        const Skin &skin = gltf.skins.at(skinId);
+        std::vector<float> inverseBindMatrices;
+        if (skin.inverseBindMatrices >= 0)
+        {
+            inverseBindMatrices = loader.ReadAsFloat(skin.inverseBindMatrices);
+            if (inverseBindMatrices.size() < skin.joints.size() * 16)
+            {
+                throw std::invalid_argument("gltf: skin " + std::to_string(skinId) + " has fewer inverseBindMatrices than joints");
+            }
+        }
+        std::vector<float> palette(skin.joints.size() * 16);
+        for (size_t j = 0; j < skin.joints.size(); j++)
+        {
+            const float *world = table.World(skin.joints[j]);
+            if (!world)
+            {
+                throw std::out_of_range("gltf: joint " + std::to_string(skin.joints[j]) + " is not in the transform table");
+            }
+            if (inverseBindMatrices.empty())
+            {
+                std::memcpy(&palette[j * 16], world, 16 * sizeof(float));
+            }
+            else
+            {
+                MultiplyMatrix(world, &inverseBindMatrices[j * 16], &palette[j * 16]);
+            }
+        }
+        return palette;
+    }
+    void MatrixToDualQuaternion(const float *m, float *dq)
+    {
+        float c[3][3];
+        for (int col = 0; col < 3; col++)
+        {
+            float length = std::sqrt(m[col * 4] * m[col * 4] + m[col * 4 + 1] * m[col * 4 + 1] + m[col * 4 + 2] * m[col * 4 + 2]);
+            float inverse = length > 0 ? 1.0f / length : 0.0f;
+            dq[8 + col] = length;
+            for (int row = 0; row < 3; row++)
+            {
+                c[col][row] = m[col * 4 + row] * inverse;
+            }
+        }
+        float *q = dq;
+        float trace = c[0][0] + c[1][1] + c[2][2];
+        if (trace > 0)
+        {
+            float s = std::sqrt(trace + 1.0f) * 2;
+            q[3] = 0.25f * s;
+            q[0] = (c[1][2] - c[2][1]) / s;
+            q[1] = (c[2][0] - c[0][2]) / s;
+            q[2] = (c[0][1] - c[1][0]) / s;
+        }
+        else if (c[0][0] > c[1][1] && c[0][0] > c[2][2])
+        {
+            float s = std::sqrt(1.0f + c[0][0] - c[1][1] - c[2][2]) * 2;
+            q[3] = (c[1][2] - c[2][1]) / s;
+            q[0] = 0.25f * s;
+            q[1] = (c[1][0] + c[0][1]) / s;
+            q[2] = (c[2][0] + c[0][2]) / s;
+        }
+        else if (c[1][1] > c[2][2])
+        {
+            float s = std::sqrt(1.0f + c[1][1] - c[0][0] - c[2][2]) * 2;
+            q[3] = (c[2][0] - c[0][2]) / s;
+            q[0] = (c[1][0] + c[0][1]) / s;
+            q[1] = 0.25f * s;
+            q[2] = (c[2][1] + c[1][2]) / s;
+        }
+        else
+        {
+            float s = std::sqrt(1.0f + c[2][2] - c[0][0] - c[1][1]) * 2;
+            q[3] = (c[0][1] - c[1][0]) / s;
+            q[0] = (c[2][0] + c[0][2]) / s;
+            q[1] = (c[2][1] + c[1][2]) / s;
+            q[2] = 0.25f * s;
+        }
+        const float *t = m + 12;
+        float *d = dq + 4;
+        d[0] = 0.5f * (t[0] * q[3] + t[1] * q[2] - t[2] * q[1]);
+        d[1] = 0.5f * (-t[0] * q[2] + t[1] * q[3] + t[2] * q[0]);
+        d[2] = 0.5f * (t[0] * q[1] - t[1] * q[0] + t[2] * q[3]);
+        d[3] = -0.5f * (t[0] * q[0] + t[1] * q[1] + t[2] * q[2]);
+    }
+    void SkinLinearBlend(const SkinningInput &input, const float *palette, size_t begin, size_t end, SkinningOutput &output)
+    {
+        bool hasNormals = !input.normals.empty();
+        bool hasTangents = !input.tangents.empty();
+        for (size_t v = begin; v < end; v++)
+        {
+            const uint16_t *joints = &input.joints[v * input.influences];
+            const float *weights = &input.weights[v * input.influences];
+            const float *p = &input.positions[v * 3];
+#if defined(__AVX2__)
+            __m256 c01 = _mm256_setzero_ps();
+            __m256 c23 = _mm256_setzero_ps();
+            for (int k = 0; k < input.influences; k++)
+            {
+                if (weights[k] == 0)
+                {
+                    continue;
+                }
+                __m256 w = _mm256_set1_ps(weights[k]);
+                const float *m = palette + (size_t)joints[k] * 16;
+                c01 = _mm256_add_ps(c01, _mm256_mul_ps(w, _mm256_loadu_ps(m)));
+                c23 = _mm256_add_ps(c23, _mm256_mul_ps(w, _mm256_loadu_ps(m + 8)));
+            }
+            __m128 c0 = _mm256_castps256_ps128(c01), c1 = _mm256_extractf128_ps(c01, 1);
+            __m128 c2 = _mm256_castps256_ps128(c23), c3 = _mm256_extractf128_ps(c23, 1);
+#elif defined(__SSE2__) || defined(_M_X64)
+            __m128 c0 = _mm_setzero_ps(), c1 = _mm_setzero_ps(), c2 = _mm_setzero_ps(), c3 = _mm_setzero_ps();
+            for (int k = 0; k < input.influences; k++)
+            {
+                if (weights[k] == 0)
+                {
+                    continue;
+                }
+                __m128 w = _mm_set1_ps(weights[k]);
+                const float *m = palette + (size_t)joints[k] * 16;
+                c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(m)));
+                c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(m + 4)));
+                c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(m + 8)));
+                c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(m + 12)));
+            }
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+            float r[4];
+            _mm_storeu_ps(r, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(p[0])), _mm_mul_ps(c1, _mm_set1_ps(p[1]))), _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(p[2])), c3)));
+            std::memcpy(&output.positions[v * 3], r, 3 * sizeof(float));
+            if (hasNormals)
+            {
+                const float *n = &input.normals[v * 3];
+                _mm_storeu_ps(r, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(n[0])), _mm_mul_ps(c1, _mm_set1_ps(n[1]))), _mm_mul_ps(c2, _mm_set1_ps(n[2]))));
+                std::memcpy(&output.normals[v * 3], r, 3 * sizeof(float));
+            }
+            if (hasTangents)
+            {
+                const float *t = &input.tangents[v * 4];
+                _mm_storeu_ps(r, _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(t[0])), _mm_mul_ps(c1, _mm_set1_ps(t[1]))), _mm_mul_ps(c2, _mm_set1_ps(t[2]))));
+                std::memcpy(&output.tangents[v * 4], r, 3 * sizeof(float));
+                output.tangents[v * 4 + 3] = t[3];
+            }
+#else
+            float m[16] = {0};
+            for (int k = 0; k < input.influences; k++)
+            {
+                const float *joint = palette + (size_t)joints[k] * 16;
+                for (int i = 0; i < 16; i++)
+                {
+                    m[i] += weights[k] * joint[i];
+                }
+            }
+            for (int i = 0; i < 3; i++)
+            {
+                output.positions[v * 3 + i] = m[i] * p[0] + m[4 + i] * p[1] + m[8 + i] * p[2] + m[12 + i];
+            }
+            if (hasNormals)
+            {
+                const float *n = &input.normals[v * 3];
+                for (int i = 0; i < 3; i++)
+                {
+                    output.normals[v * 3 + i] = m[i] * n[0] + m[4 + i] * n[1] + m[8 + i] * n[2];
+                }
+            }
+            if (hasTangents)
+            {
+                const float *t = &input.tangents[v * 4];
+                for (int i = 0; i < 3; i++)
+                {
+                    output.tangents[v * 4 + i] = m[i] * t[0] + m[4 + i] * t[1] + m[8 + i] * t[2];
+                }
+                output.tangents[v * 4 + 3] = t[3];
+            }
+#endif
+            if (hasNormals)
+            {
+                NormalizeVector(&output.normals[v * 3]);
+            }
+            if (hasTangents)
+            {
+                NormalizeVector(&output.tangents[v * 4]);
+            }
+        }
+    }
+    void RotateByQuaternion(const float *q, const float *v, float *out)
+    {
+        float tx = 2 * (q[1] * v[2] - q[2] * v[1]);
+        float ty = 2 * (q[2] * v[0] - q[0] * v[2]);
+        float tz = 2 * (q[0] * v[1] - q[1] * v[0]);
+        out[0] = v[0] + q[3] * tx + (q[1] * tz - q[2] * ty);
+        out[1] = v[1] + q[3] * ty + (q[2] * tx - q[0] * tz);
+        out[2] = v[2] + q[3] * tz + (q[0] * ty - q[1] * tx);
+    }
+    void SkinDualQuaternion(const SkinningInput &input, const float *dualQuaternions, size_t begin, size_t end, SkinningOutput &output)
+    {
+        for (size_t v = begin; v < end; v++)
+        {
+            const uint16_t *joints = &input.joints[v * input.influences];
+            const float *weights = &input.weights[v * input.influences];
+            float b[11] = {0};
+            const float *pivot = dualQuaternions + (size_t)joints[0] * 12;
+            for (int k = 0; k < input.influences; k++)
+            {
+                if (weights[k] == 0)
+                {
+                    continue;
+                }
+                const float *dq = dualQuaternions + (size_t)joints[k] * 12;
+                float w = weights[k];
+                b[8] += w * dq[8];
+                b[9] += w * dq[9];
+                b[10] += w * dq[10];
+                if (dq[0] * pivot[0] + dq[1] * pivot[1] + dq[2] * pivot[2] + dq[3] * pivot[3] < 0)
+                {
+                    w = -w;
+                }
+                for (int i = 0; i < 8; i++)
+                {
+                    b[i] += w * dq[i];
+                }
+            }
+            float length = std::sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2] + b[3] * b[3]);
+            float inverse = length > 0 ? 1.0f / length : 0.0f;
+            for (int i = 0; i < 8; i++)
+            {
+                b[i] *= inverse;
+            }
+            const float *q = b;
+            const float *d = b + 4;
+            float t[3] = {
+                2 * (-d[3] * q[0] + d[0] * q[3] - d[1] * q[2] + d[2] * q[1]),
+                2 * (-d[3] * q[1] + d[0] * q[2] + d[1] * q[3] - d[2] * q[0]),
+                2 * (-d[3] * q[2] - d[0] * q[1] + d[1] * q[0] + d[2] * q[3])};
+            const float *scale = b + 8;
+            const float *position = &input.positions[v * 3];
+            float scaled[3] = {position[0] * scale[0], position[1] * scale[1], position[2] * scale[2]};
+            float *p = &output.positions[v * 3];
+            RotateByQuaternion(q, scaled, p);
+            p[0] += t[0];
+            p[1] += t[1];
+            p[2] += t[2];
+            if (!input.normals.empty())
+            {
+                const float *normal = &input.normals[v * 3];
+                float n[3] = {normal[0] * scale[1] * scale[2], normal[1] * scale[0] * scale[2], normal[2] * scale[0] * scale[1]};
+                RotateByQuaternion(q, n, &output.normals[v * 3]);
+                NormalizeVector(&output.normals[v * 3]);
+            }
+            if (!input.tangents.empty())
+            {
+                const float *tangent = &input.tangents[v * 4];
+                float s[3] = {tangent[0] * scale[0], tangent[1] * scale[1], tangent[2] * scale[2]};
+                RotateByQuaternion(q, s, &output.tangents[v * 4]);
+                NormalizeVector(&output.tangents[v * 4]);
+                output.tangents[v * 4 + 3] = tangent[3];
+            }
+        }
+    }
+    void SkinVertices(const SkinningInput &input, const std::vector<float> &palette, SkinningOutput &output, SkinningMethod method = SkinningMethod::LINEAR_BLEND, int threads = 1, size_t chunkSize = 16384)
+    {
+        size_t joints = palette.size() / 16;
+        for (uint16_t joint : input.joints)
+        {
+            if (joint >= joints)
+            {
+                throw std::out_of_range("gltf: vertex references joint " + std::to_string(joint) + " outside the palette");
+            }
+        }
+        output.positions.resize(input.positions.size());
+        output.normals.resize(input.normals.size());
+        output.tangents.resize(input.tangents.size());
+        std::vector<float> dualQuaternions;
+        if (method == SkinningMethod::DUAL_QUATERNION)
+        {
+            dualQuaternions.resize(joints * 12);
+            for (size_t j = 0; j < joints; j++)
+            {
+                MatrixToDualQuaternion(&palette[j * 16], &dualQuaternions[j * 12]);
+            }
+        }
+        chunkSize = std::max(chunkSize, (size_t)1);
+        std::vector<std::function<void()>> tasks;
+        for (size_t begin = 0; begin < input.vertexCount; begin += chunkSize)
+        {
+            size_t end = std::min(begin + chunkSize, input.vertexCount);
+            tasks.push_back([&, begin, end]()
+            {
+                if (method == SkinningMethod::DUAL_QUATERNION)
+                {
+                    SkinDualQuaternion(input, dualQuaternions.data(), begin, end, output);
+                }
+                else
+                {
+                    SkinLinearBlend(input, palette.data(), begin, end, output);
+                }
+            });
+        }
+        RunTasks(tasks, threads);
+    }
+    class BufferBuilder
+    {
+    public:
+        BufferBuilder(glTF &_gltf) : gltf(&_gltf), buffer((int)_gltf.buffers.size()), bytes(std::make_shared<std::vector<unsigned char>>()){}
+
+        int AddBufferView(const unsigned char *data, size_t elementSize, size_t count, int target)
+        {
+            size_t stride = target == 34962 ? (elementSize + 3) & ~(size_t)3 : elementSize;
+            size_t offset = (bytes->size() + 3) & ~(size_t)3;
+            bytes->resize(offset + stride * count);
+            unsigned char *out = bytes->data() + offset;
+            if (stride == elementSize)
+            {
+                std::memcpy(out, data, elementSize * count);
+            }
+            else
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    std::memcpy(out + i * stride, data + i * elementSize, elementSize);
+                }
+            }
+            BufferView bufferView(buffer, stride * count);
+            bufferView.byteOffset = offset;
+            bufferView.target = target;
+            if (stride != elementSize)
+            {
+                bufferView.byteStride = (int)stride;
+            }
+            gltf->bufferViews.push_back(bufferView);
+            return (int)gltf->bufferViews.size() - 1;
+        }
+        int AddAccessor(const Accessor &layout, const unsigned char *data, size_t count, int target)
+        {
+            Accessor accessor(layout.componentType, count, layout.type);
+            accessor.normalized = layout.normalized;
+            if ((layout.min.size() || layout.max.size()) && count)
+            {
+                int components = ComponentCount(layout.type);
+                std::vector<float> values(count * components);
+                ConvertElementsToFloat(data, (size_t)ElementSize(layout), count, layout, false, values.data());
+                accessor.min.assign(values.begin(), values.begin() + components);
+                accessor.max.assign(values.begin(), values.begin() + components);
+                for (size_t i = components; i < values.size(); i++)
+                {
+                    accessor.min[i % components] = std::min(accessor.min[i % components], values[i]);
+                    accessor.max[i % components] = std::max(accessor.max[i % components], values[i]);
+                }
+            }
+            accessor.bufferView = AddBufferView(data, (size_t)ElementSize(accessor), count, target);
+            gltf->accessors.push_back(std::move(accessor));
+            return (int)gltf->accessors.size() - 1;
+        }
+        int AddIndices(const uint32_t *indices, size_t count, size_t vertexCount)
+        {
+            if (vertexCount > 65535)
+            {
+                return AddAccessor(Accessor(5125, count, AccessorType::SCALAR), (const unsigned char*)indices, count, 34963);
+            }
+            std::vector<uint16_t> narrow(indices, indices + count);
+            return AddAccessor(Accessor(5123, count, AccessorType::SCALAR), (const unsigned char*)narrow.data(), count, 34963);
+        }
+        int Finish()
+        {
+            if (bytes->empty())
+            {
+                return -1;
+            }
+            Buffer result(bytes->size());
+            result.data = bytes->data();
+            result.storage = bytes;
+            gltf->buffers.push_back(std::move(result));
+            bytes = std::make_shared<std::vector<unsigned char>>();
+            return buffer++;
+        }
+
+    private:
+        glTF *gltf;
+        int buffer;
+        std::shared_ptr<std::vector<unsigned char>> bytes;
+    };
+    struct PrimitiveStreams
+    {
+        std::vector<uint32_t> indices;
+        size_t vertexCount = 0;
+        std::vector<int> accessors;
+        std::vector<size_t> elementSizes;
+        std::vector<std::vector<unsigned char>> streams;
+        int position = -1;
+    };
+    PrimitiveStreams ReadPrimitiveStreams(const glTF &gltf, AssetLoader &loader, const MeshPrimitive &primitive)
+    {
+        PrimitiveStreams data;
+        for (const std::pair<Name, int> &attribute : primitive.attributes)
+        {
+            if (attribute.first == "POSITION")
+            {
+                data.position = (int)data.accessors.size();
+            }
+            data.accessors.push_back(attribute.second);
+        }
+        for (const Vector<std::pair<Name, int>> &target : primitive.targets)
+        {
+            for (const std::pair<Name, int> &attribute : target)
+            {
+                data.accessors.push_back(attribute.second);
+            }
+        }
+        for (size_t k = 0; k < data.accessors.size(); k++)
+        {
+            const Accessor &accessor = gltf.accessors.at(data.accessors[k]);
+            if (k == 0)
+            {
+                data.vertexCount = (size_t)accessor.count;
+            }
+            else if (accessor.count != data.vertexCount)
+            {
+                throw std::invalid_argument("gltf: primitive attributes have different counts");
+            }
+            data.elementSizes.push_back((size_t)ElementSize(accessor));
+            data.streams.push_back(loader.ReadElements(data.accessors[k]));
+        }
+        if (primitive.indices >= 0)
+        {
+            data.indices = loader.ReadIndices(primitive.indices);
+            for (uint32_t index : data.indices)
+            {
+                if (index >= data.vertexCount)
+                {
+                    throw std::out_of_range("gltf: index " + std::to_string(index) + " exceeds vertex count");
+                }
+            }
+        }
+        else
+        {
+            data.indices.resize(data.vertexCount);
+            for (size_t i = 0; i < data.vertexCount; i++)
+            {
+                data.indices[i] = (uint32_t)i;
+            }
+        }
+        return data;
+    }
+    struct PrimitiveTriangles
+    {
+        std::vector<uint32_t> indices;
+        std::vector<float> positions;
+    };
+    bool ReadPrimitiveTriangles(const glTF &gltf, AssetLoader &loader, const MeshPrimitive &primitive, PrimitiveTriangles &data)
+    {
+        int position = primitive.Find(AttributeSemantic::POSITION);
+        if (primitive.mode != 4 || position < 0)
+        {
+            return false;
+        }
+        if (gltf.accessors.at(position).type != AccessorType::VEC3)
+        {
+            throw std::invalid_argument("gltf: POSITION accessor " + std::to_string(position) + " isn't VEC3");
+        }
+        data.positions = loader.ReadAsFloat(position);
+        size_t vertexCount = data.positions.size() / 3;
+        if (primitive.indices >= 0)
+        {
+            data.indices = loader.ReadIndices(primitive.indices);
+            for (uint32_t index : data.indices)
+            {
+                if (index >= vertexCount)
+                {
+                    throw std::out_of_range("gltf: index " + std::to_string(index) + " exceeds vertex count");
+                }
+            }
+        }
+        else
+        {
+            data.indices.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                data.indices[i] = (uint32_t)i;
+            }
+        }
+        return true;
+    }
+    void WritePrimitiveStreams(glTF &gltf, BufferBuilder &builder, MeshPrimitive &primitive, const PrimitiveStreams &data)
+    {
+        std::vector<int> accessors(data.accessors.size());
+        for (size_t k = 0; k < accessors.size(); k++)
+        {
+            Accessor layout = gltf.accessors.at(data.accessors[k]);
+            accessors[k] = builder.AddAccessor(layout, data.streams[k].data(), data.vertexCount, 34962);
+        }
+        size_t k = 0;
+        for (std::pair<Name, int> &attribute : primitive.attributes)
+        {
+            attribute.second = accessors[k++];
+        }
+        for (Vector<std::pair<Name, int>> &target : primitive.targets)
+        {
+            for (std::pair<Name, int> &attribute : target)
+            {
+                attribute.second = accessors[k++];
+            }
+        }
+        primitive.indices = builder.AddIndices(data.indices.data(), data.indices.size(), data.vertexCount);
+        primitive.Resolve();
+    }
+    template<typename T>
+    std::vector<int> RemoveUnused(Vector<T> &items, const std::vector<char> &used)
+    {
+        std::vector<int> remap(items.size(), -1);
+        size_t kept = 0;
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if (used[i])
+            {
+                if (kept != i)
+                {
+                    items[kept] = std::move(items[i]);
+                }
+                remap[i] = (int)kept++;
+            }
+        }
+        items.erase(items.begin() + kept, items.end());
+        return remap;
+    }
+    void RemapReference(const std::vector<int> &remap, int &id)
+    {
+        if (id >= 0)
+        {
+            id = remap.at(id);
+        }
+    }
+    void MarkReference(std::vector<char> &used, int id)
+    {
+        if (id >= 0)
+        {
+            used.at(id) = 1;
+        }
+    }
+    struct DataReferences
+    {
+        std::vector<char> accessors;
+        std::vector<char> bufferViews;
+        std::vector<char> buffers;
+    };
+    DataReferences MarkUsedData(const glTF &gltf)
+    {
+        DataReferences used;
+        std::vector<char> &accessors = used.accessors;
+        accessors.resize(gltf.accessors.size());
+        for (const Mesh &mesh : gltf.meshes)
+        {
+            for (const MeshPrimitive &primitive : mesh.primitives)
+            {
+                for (const std::pair<Name, int> &attribute : primitive.attributes)
+                {
+                    MarkReference(accessors, attribute.second);
+                }
+                for (const Vector<std::pair<Name, int>> &target : primitive.targets)
+                {
+                    for (const std::pair<Name, int> &attribute : target)
+                    {
+                        MarkReference(accessors, attribute.second);
+                    }
+                }
+                MarkReference(accessors, primitive.indices);
+            }
+        }
+        for (const Skin &skin : gltf.skins)
+        {
+            MarkReference(accessors, skin.inverseBindMatrices);
+        }
+        for (const Animation &animation : gltf.animations)
+        {
+            for (const AnimationSampler &sampler : animation.samplers)
+            {
+                MarkReference(accessors, sampler.input);
+                MarkReference(accessors, sampler.output);
+            }
+        }
+        std::vector<char> &bufferViews = used.bufferViews;
+        bufferViews.resize(gltf.bufferViews.size());
+        for (size_t i = 0; i < gltf.accessors.size(); i++)
+        {
+            const Accessor &accessor = gltf.accessors[i];
+            if (accessors[i])
+            {
+                MarkReference(bufferViews, accessor.bufferView);
+                if (accessor.hasSparse())
+                {
+                    MarkReference(bufferViews, accessor.sparse.indices.bufferView);
+                    MarkReference(bufferViews, accessor.sparse.values.bufferView);
+                }
+            }
+        }
+        for (const Image &image : gltf.images)
+        {
+            MarkReference(bufferViews, image.bufferView);
+        }
+        std::vector<char> &buffers = used.buffers;
+        buffers.resize(gltf.buffers.size());
+        for (size_t i = 0; i < gltf.bufferViews.size(); i++)
+        {
+            if (bufferViews[i])
+            {
+                MarkReference(buffers, gltf.bufferViews[i].buffer);
+            }
+        }
+        return used;
+    }
+    void KeepUnorphaned(std::vector<char> &used, const std::vector<char> &before)
+    {
+        for (size_t i = 0; i < used.size(); i++)
+        {
+            used[i] = used[i] || i >= before.size() || !before[i];
+        }
+    }
+    void RemoveOrphanedData(glTF &gltf, const DataReferences &before)
+    {
+        DataReferences used = MarkUsedData(gltf);
+        KeepUnorphaned(used.accessors, before.accessors);
+        for (size_t i = 0; i < gltf.accessors.size(); i++)
+        {
+            const Accessor &accessor = gltf.accessors[i];
+            if (used.accessors[i])
+            {
+                MarkReference(used.bufferViews, accessor.bufferView);
+                if (accessor.hasSparse())
+                {
+                    MarkReference(used.bufferViews, accessor.sparse.indices.bufferView);
+                    MarkReference(used.bufferViews, accessor.sparse.values.bufferView);
+                }
+            }
+        }
+        KeepUnorphaned(used.bufferViews, before.bufferViews);
+        for (size_t i = 0; i < gltf.bufferViews.size(); i++)
+        {
+            if (used.bufferViews[i])
+            {
+                MarkReference(used.buffers, gltf.bufferViews[i].buffer);
+            }
+        }
+        KeepUnorphaned(used.buffers, before.buffers);
+        std::vector<int> bufferRemap = RemoveUnused(gltf.buffers, used.buffers);
+        std::vector<int> bufferViewRemap = RemoveUnused(gltf.bufferViews, used.bufferViews);
+        std::vector<int> accessorRemap = RemoveUnused(gltf.accessors, used.accessors);
+        for (BufferView &bufferView : gltf.bufferViews)
+        {
+            RemapReference(bufferRemap, bufferView.buffer);
+        }
+        for (Accessor &accessor : gltf.accessors)
+        {
+            RemapReference(bufferViewRemap, accessor.bufferView);
+            if (accessor.hasSparse())
+            {
+                RemapReference(bufferViewRemap, accessor.sparse.indices.bufferView);
+                RemapReference(bufferViewRemap, accessor.sparse.values.bufferView);
+            }
+        }
+        for (Image &image : gltf.images)
+        {
+            RemapReference(bufferViewRemap, image.bufferView);
+        }
+        for (Mesh &mesh : gltf.meshes)
+        {
+            for (MeshPrimitive &primitive : mesh.primitives)
+            {
+                for (std::pair<Name, int> &attribute : primitive.attributes)
+                {
+                    RemapReference(accessorRemap, attribute.second);
+                }
+                for (Vector<std::pair<Name, int>> &target : primitive.targets)
+                {
+                    for (std::pair<Name, int> &attribute : target)
+                    {
+                        RemapReference(accessorRemap, attribute.second);
+                    }
+                }
+                RemapReference(accessorRemap, primitive.indices);
+                primitive.Resolve();
+            }
+        }
+        for (Skin &skin : gltf.skins)
+        {
+            RemapReference(accessorRemap, skin.inverseBindMatrices);
+        }
+        for (Animation &animation : gltf.animations)
+        {
+            for (AnimationSampler &sampler : animation.samplers)
+            {
+                RemapReference(accessorRemap, sampler.input);
+                RemapReference(accessorRemap, sampler.output);
+            }
+        }
+    }
+    uint32_t HashRow(const unsigned char *row, size_t size)
+    {
+        const uint32_t m = 0x5bd1e995;
+        uint32_t h = (uint32_t)size;
+        for (size_t i = 0; i + 4 <= size; i += 4)
+        {
+            uint32_t k;
+            std::memcpy(&k, row + i, 4);
+            k *= m;
+            k ^= k >> 24;
+            k *= m;
+            h = (h * m) ^ k;
+        }
+        h ^= h >> 13;
+        h *= m;
+        h ^= h >> 15;
+        return h;
+    }
+    struct VertexStream
+    {
+        const unsigned char *data = nullptr;
+        size_t elementSize = 0;
+        float epsilon = 0;
+
+        VertexStream() = default;
+        VertexStream(const unsigned char *_data, size_t _elementSize, float _epsilon = 0) : data(_data), elementSize(_elementSize), epsilon(_epsilon){}
+    };
+    size_t GenerateVertexRemap(const std::vector<VertexStream> &streams, size_t vertexCount, const uint32_t *indices, size_t indexCount, uint32_t *remap)
+    {
+        size_t rowSize = 0;
+        for (const VertexStream &stream : streams)
+        {
+            rowSize += (stream.elementSize + 3) & ~(size_t)3;
+        }
+        std::vector<unsigned char> rows(vertexCount * rowSize);
+        size_t offset = 0;
+        for (const VertexStream &stream : streams)
+        {
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                unsigned char *row = &rows[v * rowSize + offset];
+                const unsigned char *element = stream.data + v * stream.elementSize;
+                if (stream.epsilon <= 0)
+                {
+                    std::memcpy(row, element, stream.elementSize);
+                    continue;
+                }
+                for (size_t c = 0; c + 4 <= stream.elementSize; c += 4)
+                {
+                    float value;
+                    std::memcpy(&value, element + c, 4);
+                    int32_t cell = (int32_t)std::max(-2147483648.0, std::min(2147483647.0, std::floor((double)value / stream.epsilon + 0.5)));
+                    std::memcpy(row + c, &cell, 4);
+                }
+            }
+            offset += (stream.elementSize + 3) & ~(size_t)3;
+        }
+
+        size_t tableSize = 16;
+        while (tableSize < vertexCount * 2)
+        {
+            tableSize *= 2;
+        }
+        const uint32_t empty = ~0u;
+        std::vector<uint32_t> table(tableSize, empty);
+        std::fill(remap, remap + vertexCount, empty);
+        size_t unique = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            uint32_t v = indices[i];
+            if (remap[v] != empty)
+            {
+                continue;
+            }
+            const unsigned char *row = &rows[v * rowSize];
+            size_t slot = HashRow(row, rowSize) & (tableSize - 1);
+            while (table[slot] != empty && std::memcmp(&rows[table[slot] * rowSize], row, rowSize) != 0)
+            {
+                slot = (slot + 1) & (tableSize - 1);
+            }
+            if (table[slot] == empty)
+            {
+                table[slot] = v;
+                remap[v] = (uint32_t)unique++;
+            }
+            else
+            {
+                remap[v] = remap[table[slot]];
+            }
+        }
+        return unique;
+    }
+    void RemapVertexStream(const unsigned char *src, size_t elementSize, size_t vertexCount, const uint32_t *remap, unsigned char *out)
+    {
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            if (remap[v] != ~0u)
+            {
+                std::memcpy(out + (size_t)remap[v] * elementSize, src + v * elementSize, elementSize);
+            }
+        }
+    }
+    void RemapIndices(const uint32_t *indices, size_t count, const uint32_t *remap, uint32_t *out)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            out[i] = remap[indices[i]];
+        }
+    }
+    struct WeldOptions
+    {
+        float positionEpsilon = 0;
+        int threads = 1;
+
+        WeldOptions() = default;
+        WeldOptions(float _positionEpsilon, int _threads = 1) : positionEpsilon(_positionEpsilon), threads(_threads){}
+    };
+    struct WeldStats
+    {
+        size_t primitives = 0;
+        size_t vertices = 0;
+        size_t uniqueVertices = 0;
+    };
+    WeldStats WeldVertices(glTF &gltf, AssetLoader &loader, const WeldOptions &options = WeldOptions())
+    {
+        DataReferences referenced = MarkUsedData(gltf);
+        std::vector<MeshPrimitive*> primitives;
+        std::vector<PrimitiveStreams> data;
+        for (Mesh &mesh : gltf.meshes)
+        {
+            for (MeshPrimitive &primitive : mesh.primitives)
+            {
+                if (primitive.attributes.size())
+                {
+                    primitives.push_back(&primitive);
+                    data.push_back(ReadPrimitiveStreams(gltf, loader, primitive));
+                }
+            }
+        }
+        WeldStats stats;
+        std::vector<size_t> vertices(data.size());
+        std::vector<char> changed(data.size());
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            tasks.push_back([&, i]()
+            {
+                PrimitiveStreams &d = data[i];
+                std::vector<VertexStream> streams;
+                for (size_t k = 0; k < d.streams.size(); k++)
+                {
+                    bool weld = (int)k == d.position && gltf.accessors[d.accessors[k]].componentType == 5126;
+                    streams.emplace_back(d.streams[k].data(), d.elementSizes[k], weld ? options.positionEpsilon : 0.0f);
+                }
+                std::vector<uint32_t> remap(d.vertexCount);
+                size_t unique = GenerateVertexRemap(streams, d.vertexCount, d.indices.data(), d.indices.size(), remap.data());
+                vertices[i] = d.vertexCount;
+                bool identity = unique == d.vertexCount && primitives[i]->indices >= 0;
+                for (size_t v = 0; identity && v < d.vertexCount; v++)
+                {
+                    identity = remap[v] == v;
+                }
+                if (identity)
+                {
+                    return;
+                }
+                for (size_t k = 0; k < d.streams.size(); k++)
+                {
+                    std::vector<unsigned char> out(unique * d.elementSizes[k]);
+                    RemapVertexStream(d.streams[k].data(), d.elementSizes[k], d.vertexCount, remap.data(), out.data());
+                    d.streams[k].swap(out);
+                }
+                RemapIndices(d.indices.data(), d.indices.size(), remap.data(), d.indices.data());
+                d.vertexCount = unique;
+                changed[i] = 1;
+            });
+        }
+        RunTasks(tasks, options.threads);
+        BufferBuilder builder(gltf);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            stats.vertices += vertices[i];
+            stats.uniqueVertices += data[i].vertexCount;
+            if (changed[i])
+            {
+                WritePrimitiveStreams(gltf, builder, *primitives[i], data[i]);
+                stats.primitives++;
+            }
+        }
+        builder.Finish();
+        if (stats.primitives)
+        {
+            RemoveOrphanedData(gltf, referenced);
+            loader.Reset();
+        }
+        return stats;
+    }
+    struct VertexCacheStats
+    {
+        size_t triangles = 0;
+        size_t vertices = 0;
+        size_t transforms = 0;
+
+        float acmr() const
+        {
+            return triangles ? (float)transforms / triangles : 0.0f;
+        }
+        float atvr() const
+        {
+            return vertices ? (float)transforms / vertices : 0.0f;
+        }
+        VertexCacheStats &operator+=(const VertexCacheStats &other)
+        {
+            triangles += other.triangles;
+            vertices += other.vertices;
+            transforms += other.transforms;
+            return *this;
+        }
+    };
+    VertexCacheStats AnalyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, int cacheSize = 16)
+    {
+        const size_t none = ~(size_t)0;
+        std::vector<size_t> stamps(vertexCount, none);
+        VertexCacheStats stats;
+        stats.triangles = indexCount / 3;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            size_t &stamp = stamps[indices[i]];
+            if (stamp == none)
+            {
+                stats.vertices++;
+            }
+            else if (stats.transforms - stamp < (size_t)cacheSize)
+            {
+                continue;
+            }
+            stamp = stats.transforms++;
+        }
+        return stats;
+    }
+    void BuildTriangleAdjacency(const uint32_t *indices, size_t triangleCount, size_t vertexCount, std::vector<uint32_t> &offsets, std::vector<uint32_t> &adjacency)
+    {
+        offsets.assign(vertexCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            offsets[indices[i] + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            offsets[v + 1] += offsets[v];
+        }
+        adjacency.resize(triangleCount * 3);
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangleCount * 3; i++)
+        {
+            adjacency[cursor[indices[i]]++] = (uint32_t)(i / 3);
+        }
+    }
+    void OptimizeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t *out, int cacheSize = 16, std::vector<size_t> *clusters = nullptr)
+    {
+        size_t triangleCount = indexCount / 3;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> adjacency;
+        BuildTriangleAdjacency(indices, triangleCount, vertexCount, offsets, adjacency);
+        std::vector<uint32_t> live(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            live[v] = offsets[v + 1] - offsets[v];
+        }
+        std::vector<size_t> stamps(vertexCount, 0);
+        std::vector<char> emitted(triangleCount);
+        std::vector<uint32_t> deadEnds;
+        std::vector<uint32_t> candidates;
+        size_t time = (size_t)cacheSize + 1;
+        size_t scan = 0;
+        size_t written = 0;
+        int64_t fan = -1;
+        while (true)
+        {
+            if (fan < 0)
+            {
+                while (deadEnds.size() && fan < 0)
+                {
+                    uint32_t v = deadEnds.back();
+                    deadEnds.pop_back();
+                    if (live[v] > 0)
+                    {
+                        fan = v;
+                    }
                 }
-                if (NODE.contains("scale"))
+                while (fan < 0 && scan < vertexCount)
                 {
-                    json SCALE = NODE["scale"];
-                    for (int j = 0; j < SCALE.size(); j++)
+                    if (live[scan] > 0)
                     {
-                        node.scale[j] = SCALE.at(j);
+                        fan = (int64_t)scan;
                     }
+                    scan++;
+                }
+                if (fan < 0)
+                {
+                    break;
+                }
+                if (clusters)
+                {
+                    clusters->push_back(written / 3);
+                }
+            }
+            candidates.clear();
+            for (uint32_t k = offsets[fan]; k < offsets[fan + 1]; k++)
+            {
+                uint32_t t = adjacency[k];
+                if (emitted[t])
+                {
+                    continue;
                 }
-                node.skin = NODE.value("skin", -1);
-                if (NODE.contains("translation"))
+                emitted[t] = 1;
+                for (int c = 0; c < 3; c++)
                 {
-                    json TRANSLATION = NODE["translation"];
-                    for (int j = 0; j < TRANSLATION.size(); j++)
+                    uint32_t v = indices[t * 3 + c];
+                    out[written++] = v;
+                    deadEnds.push_back(v);
+                    candidates.push_back(v);
+                    live[v]--;
+                    if (time - stamps[v] > (size_t)cacheSize)
                     {
-                        node.translation[j] = TRANSLATION.at(j);
+                        stamps[v] = time++;
                     }
                 }
-                gltf.nodes.push_back(node);
+            }
+            fan = -1;
+            int64_t best = -1;
+            for (uint32_t v : candidates)
+            {
+                if (live[v] == 0)
+                {
+                    continue;
+                }
+                int64_t priority = 0;
+                if (time - stamps[v] + 2 * live[v] <= (size_t)cacheSize)
+                {
+                    priority = (int64_t)(time - stamps[v]);
+                }
+                if (priority > best)
+                {
+                    best = priority;
+                    fan = v;
+                }
+            }
+        }
+    }
+    void OptimizeOverdraw(uint32_t *indices, size_t indexCount, const float *positions, size_t vertexCount, const std::vector<size_t> &clusters, int cacheSize = 16, float threshold = 1.05f)
+    {
+        size_t triangleCount = indexCount / 3;
+        if (clusters.size() < 2 || triangleCount == 0)
+        {
+            return;
+        }
+        float center[3] = {0, 0, 0};
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            for (int c = 0; c < 3; c++)
+            {
+                center[c] += positions[v * 3 + c] / vertexCount;
+            }
+        }
+        std::vector<float> sortKeys(clusters.size());
+        for (size_t k = 0; k < clusters.size(); k++)
+        {
+            size_t end = k + 1 < clusters.size() ? clusters[k + 1] : triangleCount;
+            float centroid[3] = {0, 0, 0};
+            float normal[3] = {0, 0, 0};
+            float area = 0;
+            for (size_t t = clusters[k]; t < end; t++)
+            {
+                const float *a = &positions[indices[t * 3] * 3];
+                const float *b = &positions[indices[t * 3 + 1] * 3];
+                const float *c = &positions[indices[t * 3 + 2] * 3];
+                float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+                float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+                float n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0]};
+                float weight = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                for (int j = 0; j < 3; j++)
+                {
+                    centroid[j] += (a[j] + b[j] + c[j]) * weight;
+                    normal[j] += n[j];
+                }
+                area += weight;
+            }
+            float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            float key = 0;
+            if (area > 0 && length > 0)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    key += (centroid[j] / (area * 3) - center[j]) * normal[j] / length;
+                }
+            }
+            sortKeys[k] = key;
+        }
+        std::vector<size_t> order(clusters.size());
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            order[k] = k;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b)
+        {
+            return sortKeys[a] > sortKeys[b];
+        });
+        std::vector<uint32_t> sorted;
+        sorted.reserve(triangleCount * 3);
+        for (size_t k : order)
+        {
+            size_t end = k + 1 < clusters.size() ? clusters[k + 1] : triangleCount;
+            sorted.insert(sorted.end(), indices + clusters[k] * 3, indices + end * 3);
+        }
+        float before = AnalyzeVertexCache(indices, triangleCount * 3, vertexCount, cacheSize).acmr();
+        float after = AnalyzeVertexCache(sorted.data(), sorted.size(), vertexCount, cacheSize).acmr();
+        if (after <= before * threshold)
+        {
+            std::copy(sorted.begin(), sorted.end(), indices);
+        }
+    }
+    size_t OptimizeVertexFetch(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t *remap)
+    {
+        std::fill(remap, remap + vertexCount, ~0u);
+        size_t unique = 0;
+        for (size_t i = 0; i < indexCount; i++)
+        {
+            if (remap[indices[i]] == ~0u)
+            {
+                remap[indices[i]] = (uint32_t)unique++;
             }
         }
-        if (GLTF.contains("animations"))
+        return unique;
+    }
+    struct VertexCacheOptions
+    {
+        int cacheSize = 16;
+        float overdrawThreshold = 1.05f;
+        int threads = 1;
+
+        VertexCacheOptions() = default;
+        VertexCacheOptions(int _cacheSize, int _threads = 1) : cacheSize(_cacheSize), threads(_threads){}
+    };
+    struct VertexCacheResult
+    {
+        size_t primitives = 0;
+        VertexCacheStats before;
+        VertexCacheStats after;
+    };
+    VertexCacheResult OptimizeVertexCache(glTF &gltf, AssetLoader &loader, const VertexCacheOptions &options = VertexCacheOptions())
+    {
+        DataReferences referenced = MarkUsedData(gltf);
+        std::vector<MeshPrimitive*> primitives;
+        std::vector<PrimitiveStreams> data;
+        for (Mesh &mesh : gltf.meshes)
         {
-            json ANIMATIONS = GLTF["animations"];
-            for (int i = 0; i < ANIMATIONS.size(); i++)
+            for (MeshPrimitive &primitive : mesh.primitives)
             {
-                json ANIMATION = ANIMATIONS.at(i);
-                json CHANNELS = ANIMATION["channels"];
-                std::vector<AnimationChannel> channels;
-                for (int j = 0; j < CHANNELS.size(); j++)
-                {
-                    json CHANNEL = CHANNELS.at(j);
-                    json TARGET = CHANNEL["target"];
-                    std::string path = TARGET["path"];
-                    AnimationChannelTarget target(path);
-                    target.node = TARGET.value("node", -1);
-                    int sampler = CHANNEL["sampler"];
-                    AnimationChannel channel(sampler, target);
-                    channels.push_back(channel);
-                }
-                json SAMPLERS = ANIMATION["samplers"];
-                std::vector<AnimationSampler> samplers;
-                for (int j = 0; j < SAMPLERS.size(); j++)
+                if (primitive.mode == 4 && primitive.attributes.size())
                 {
-                    json SAMPLER = SAMPLERS.at(j);
-                    int input = SAMPLER["input"];
-                    int output = SAMPLER["output"];
-                    AnimationSampler sampler(input, output);
-                    if (SAMPLER.contains("interpolation"))
+                    primitives.push_back(&primitive);
+                    data.push_back(ReadPrimitiveStreams(gltf, loader, primitive));
+                    if (data.back().indices.size() % 3)
                     {
-                        sampler.interpolation = SAMPLER["interpolation"];
+                        throw std::invalid_argument("gltf: triangle primitive index count isn't a multiple of 3");
                     }
-                    samplers.push_back(sampler);
                 }
-                Animation animation(channels, samplers);
-                animation.name = ANIMATION.value("name", "");
-                gltf.animations.push_back(animation);
             }
         }
-        if (GLTF.contains("materials"))
+        std::vector<VertexCacheStats> before(data.size());
+        std::vector<VertexCacheStats> after(data.size());
+        std::vector<char> changed(data.size());
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < data.size(); i++)
         {
-            json MATERIALS = GLTF["materials"];
-            for (int i = 0; i < MATERIALS.size(); i++)
+            tasks.push_back([&, i]()
             {
-                json MATERIAL = MATERIALS.at(i);
-                std::string name = MATERIAL.value("name", "");
-                Material material;
-                if (MATERIAL.contains("alphaCutoff"))
+                PrimitiveStreams &d = data[i];
+                before[i] = AnalyzeVertexCache(d.indices.data(), d.indices.size(), d.vertexCount, options.cacheSize);
+                std::vector<uint32_t> optimized(d.indices.size());
+                std::vector<size_t> clusters;
+                OptimizeVertexCache(d.indices.data(), d.indices.size(), d.vertexCount, optimized.data(), options.cacheSize, &clusters);
+                if (d.position >= 0 && gltf.accessors[d.accessors[d.position]].componentType == 5126 && gltf.accessors[d.accessors[d.position]].type == AccessorType::VEC3 && options.overdrawThreshold > 0)
                 {
-                    material.alphaCutoff = MATERIAL["alphaCutoff"];
+                    OptimizeOverdraw(optimized.data(), optimized.size(), (const float*)d.streams[d.position].data(), d.vertexCount, clusters, options.cacheSize, options.overdrawThreshold);
                 }
-                if (MATERIAL.contains("alphaMode"))
+                std::vector<uint32_t> remap(d.vertexCount);
+                size_t unique = OptimizeVertexFetch(optimized.data(), optimized.size(), d.vertexCount, remap.data());
+                RemapIndices(optimized.data(), optimized.size(), remap.data(), optimized.data());
+                after[i] = AnalyzeVertexCache(optimized.data(), optimized.size(), unique, options.cacheSize);
+                if (after[i].transforms > before[i].transforms || (unique == d.vertexCount && optimized == d.indices && primitives[i]->indices >= 0))
                 {
-                    material.alphaMode = MATERIAL["alphaMode"];
+                    after[i] = before[i];
+                    return;
                 }
-                if (MATERIAL.contains("doubleSided"))
+                for (size_t k = 0; k < d.streams.size(); k++)
                 {
-                    material.doubleSided = MATERIAL["doubleSided"];
+                    std::vector<unsigned char> out(unique * d.elementSizes[k]);
+                    RemapVertexStream(d.streams[k].data(), d.elementSizes[k], d.vertexCount, remap.data(), out.data());
+                    d.streams[k].swap(out);
                 }
-                if (MATERIAL.contains("emissiveFactor"))
+                d.indices.swap(optimized);
+                d.vertexCount = unique;
+                changed[i] = 1;
+            });
+        }
+        RunTasks(tasks, options.threads);
+        VertexCacheResult result;
+        BufferBuilder builder(gltf);
+        for (size_t i = 0; i < data.size(); i++)
+        {
+            if (changed[i])
+            {
+                WritePrimitiveStreams(gltf, builder, *primitives[i], data[i]);
+                result.primitives++;
+            }
+            result.before += before[i];
+            result.after += after[i];
+        }
+        builder.Finish();
+        if (result.primitives)
+        {
+            RemoveOrphanedData(gltf, referenced);
+            loader.Reset();
+        }
+        return result;
+    }
+    struct Meshlet
+    {
+        uint32_t vertexOffset = 0;
+        uint32_t triangleOffset = 0;
+        uint32_t vertexCount = 0;
+        uint32_t triangleCount = 0;
+        float center[3] = {0, 0, 0};
+        float radius = 0;
+        float coneApex[3] = {0, 0, 0};
+        float coneAxis[3] = {0, 0, 0};
+        float coneCutoff = 1;
+
+        bool isBackfacing(const float *cameraPosition) const
+        {
+            float d[3] = {coneApex[0] - cameraPosition[0], coneApex[1] - cameraPosition[1], coneApex[2] - cameraPosition[2]};
+            float length = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            return d[0] * coneAxis[0] + d[1] * coneAxis[1] + d[2] * coneAxis[2] > coneCutoff * length;
+        }
+    };
+    struct MeshletSet
+    {
+        std::vector<Meshlet> meshlets;
+        std::vector<uint32_t> vertices;
+        std::vector<uint8_t> triangles;
+    };
+    void ComputeMeshletBounds(const float *positions, const uint32_t *vertices, const uint8_t *triangles, Meshlet &meshlet)
+    {
+        const float *first = &positions[vertices[0] * 3];
+        const float *a = first;
+        const float *b = first;
+        float farthest = -1;
+        for (uint32_t k = 0; k < meshlet.vertexCount; k++)
+        {
+            const float *p = &positions[vertices[k] * 3];
+            float d = (p[0] - first[0]) * (p[0] - first[0]) + (p[1] - first[1]) * (p[1] - first[1]) + (p[2] - first[2]) * (p[2] - first[2]);
+            if (d > farthest)
+            {
+                farthest = d;
+                a = p;
+            }
+        }
+        farthest = -1;
+        for (uint32_t k = 0; k < meshlet.vertexCount; k++)
+        {
+            const float *p = &positions[vertices[k] * 3];
+            float d = (p[0] - a[0]) * (p[0] - a[0]) + (p[1] - a[1]) * (p[1] - a[1]) + (p[2] - a[2]) * (p[2] - a[2]);
+            if (d > farthest)
+            {
+                farthest = d;
+                b = p;
+            }
+        }
+        float *center = meshlet.center;
+        for (int j = 0; j < 3; j++)
+        {
+            center[j] = (a[j] + b[j]) * 0.5f;
+        }
+        float radius = std::sqrt(farthest) * 0.5f;
+        for (uint32_t k = 0; k < meshlet.vertexCount; k++)
+        {
+            const float *p = &positions[vertices[k] * 3];
+            float d = std::sqrt((p[0] - center[0]) * (p[0] - center[0]) + (p[1] - center[1]) * (p[1] - center[1]) + (p[2] - center[2]) * (p[2] - center[2]));
+            if (d > radius)
+            {
+                float grown = (radius + d) * 0.5f;
+                for (int j = 0; j < 3; j++)
                 {
-                    json EMISSIVE_FACTOR = MATERIAL["emissiveFactor"];
-                    for (int j = 0; j < EMISSIVE_FACTOR.size(); j++)
-                    {
-                        material.emissiveFactor[j] = EMISSIVE_FACTOR.at(j);
-                    }
+                    center[j] += (p[j] - center[j]) * (grown - radius) / d;
                 }
-                if (MATERIAL.contains("emissiveTexture"))
+                radius = grown;
+            }
+        }
+        meshlet.radius = radius;
+
+        std::vector<float> normals(meshlet.triangleCount * 3);
+        float axis[3] = {0, 0, 0};
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float *p0 = &positions[vertices[triangles[t * 3]] * 3];
+            const float *p1 = &positions[vertices[triangles[t * 3 + 1]] * 3];
+            const float *p2 = &positions[vertices[triangles[t * 3 + 2]] * 3];
+            float e1[3] = {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]};
+            float e2[3] = {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]};
+            float *n = &normals[t * 3];
+            n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+            n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+            n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+            float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (int j = 0; j < 3; j++)
+            {
+                n[j] = length > 0 ? n[j] / length : 0.0f;
+                axis[j] += n[j];
+            }
+        }
+        float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        std::copy(center, center + 3, meshlet.coneApex);
+        meshlet.coneCutoff = 1;
+        if (length <= 0)
+        {
+            return;
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            meshlet.coneAxis[j] = axis[j] / length;
+        }
+        float minDot = 1;
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float *n = &normals[t * 3];
+            if (n[0] != 0 || n[1] != 0 || n[2] != 0)
+            {
+                minDot = std::min(minDot, n[0] * meshlet.coneAxis[0] + n[1] * meshlet.coneAxis[1] + n[2] * meshlet.coneAxis[2]);
+            }
+        }
+        if (minDot <= 0.1f)
+        {
+            return;
+        }
+        float maxT = 0;
+        for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+        {
+            const float *n = &normals[t * 3];
+            const float *p0 = &positions[vertices[triangles[t * 3]] * 3];
+            float dn = n[0] * meshlet.coneAxis[0] + n[1] * meshlet.coneAxis[1] + n[2] * meshlet.coneAxis[2];
+            if (dn > 0)
+            {
+                float dc = (center[0] - p0[0]) * n[0] + (center[1] - p0[1]) * n[1] + (center[2] - p0[2]) * n[2];
+                maxT = std::max(maxT, dc / dn);
+            }
+        }
+        for (int j = 0; j < 3; j++)
+        {
+            meshlet.coneApex[j] = center[j] - meshlet.coneAxis[j] * maxT;
+        }
+        meshlet.coneCutoff = std::sqrt(1 - minDot * minDot);
+    }
+    void FinishMeshlet(MeshletSet &set, Meshlet &meshlet, std::vector<int> &local, const float *positions)
+    {
+        ComputeMeshletBounds(positions, &set.vertices[meshlet.vertexOffset], &set.triangles[meshlet.triangleOffset], meshlet);
+        set.meshlets.push_back(meshlet);
+        for (size_t k = meshlet.vertexOffset; k < set.vertices.size(); k++)
+        {
+            local[set.vertices[k]] = -1;
+        }
+        meshlet = Meshlet();
+        meshlet.vertexOffset = (uint32_t)set.vertices.size();
+        meshlet.triangleOffset = (uint32_t)set.triangles.size();
+    }
+    MeshletSet BuildMeshlets(const uint32_t *indices, size_t indexCount, const float *positions, size_t vertexCount, size_t maxVertices = 64, size_t maxTriangles = 124)
+    {
+        if (maxVertices < 3 || maxVertices > 256 || maxTriangles < 1 || maxTriangles > 512)
+        {
+            throw std::invalid_argument("gltf: meshlets need 3 to 256 vertices and 1 to 512 triangles");
+        }
+        size_t triangleCount = indexCount / 3;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> adjacency;
+        BuildTriangleAdjacency(indices, triangleCount, vertexCount, offsets, adjacency);
+        std::vector<char> used(triangleCount);
+        std::vector<int> local(vertexCount, -1);
+        std::vector<uint32_t> live(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            live[v] = offsets[v + 1] - offsets[v];
+        }
+        MeshletSet set;
+        Meshlet meshlet;
+        float sum[3] = {0, 0, 0};
+        size_t scan = 0;
+        int64_t best = -1;
+        while (true)
+        {
+            int64_t previous = best;
+            best = -1;
+            if (meshlet.triangleCount)
+            {
+                uint32_t recent[3] = {indices[previous * 3], indices[previous * 3 + 1], indices[previous * 3 + 2]};
+                float mean[3] = {sum[0] / meshlet.vertexCount, sum[1] / meshlet.vertexCount, sum[2] / meshlet.vertexCount};
+                int bestExtra = 4;
+                float bestDistance = std::numeric_limits<float>::max();
+                for (int pass = 0; pass < 2 && best < 0; pass++)
                 {
-                    json EMISSIVE_TEXTURE = MATERIAL["emissiveTexture"];
-                    int index = EMISSIVE_TEXTURE["index"];
-                    material.emissiveTexture = TextureInfo(index);
-                    if (EMISSIVE_TEXTURE.contains("texCoord"))
+                    size_t first = pass ? meshlet.vertexOffset : 0;
+                    size_t last = pass ? set.vertices.size() : 3;
+                    for (size_t k = first; k < last; k++)
                     {
-                        int texCoord = EMISSIVE_TEXTURE["texCoord"];
-                        material.emissiveTexture.texCoord = texCoord;
+                        uint32_t v = pass ? set.vertices[k] : recent[k];
+                        if (live[v] == 0)
+                        {
+                            continue;
+                        }
+                        for (uint32_t j = offsets[v]; j < offsets[v + 1]; j++)
+                        {
+                            uint32_t t = adjacency[j];
+                            if (used[t])
+                            {
+                                continue;
+                            }
+                            uint32_t a = indices[t * 3];
+                            uint32_t b = indices[t * 3 + 1];
+                            uint32_t c = indices[t * 3 + 2];
+                            int extra = (local[a] < 0) + (local[b] < 0 && b != a) + (local[c] < 0 && c != a && c != b);
+                            if (meshlet.vertexCount + extra > maxVertices)
+                            {
+                                continue;
+                            }
+                            if (live[a] == 1 || live[b] == 1 || live[c] == 1)
+                            {
+                                extra = 0;
+                            }
+                            float distance = 0;
+                            for (int x = 0; x < 3; x++)
+                            {
+                                float d = (positions[a * 3 + x] + positions[b * 3 + x] + positions[c * 3 + x]) / 3 - mean[x];
+                                distance += d * d;
+                            }
+                            if (extra < bestExtra || (extra == bestExtra && distance < bestDistance))
+                            {
+                                best = t;
+                                bestExtra = extra;
+                                bestDistance = distance;
+                            }
+                        }
                     }
                 }
-                material.name = MATERIAL.value("name", "");
-                if (MATERIAL.contains("normalTexture"))
+            }
+            if (best < 0)
+            {
+                if (meshlet.triangleCount)
                 {
-                    json NORMAL_TEXTURE = MATERIAL["normalTexture"];
-                    int index = NORMAL_TEXTURE["index"];
-                    MaterialNormalTextureInfo normalTexture = MaterialNormalTextureInfo(index);
-                    material.normalTexture = normalTexture;
-                    if (NORMAL_TEXTURE.contains("texCoord"))
-                    {
-                        int texCoord = NORMAL_TEXTURE["texCoord"];
-                        material.normalTexture.texCoord = texCoord;
-                    }
-                    if (NORMAL_TEXTURE.contains("scale"))
-                    {
-                        float scale = NORMAL_TEXTURE["scale"];
-                        material.normalTexture.scale = scale;
-                    }
+                    FinishMeshlet(set, meshlet, local, positions);
+                    std::fill(sum, sum + 3, 0.0f);
                 }
-                if (MATERIAL.contains("occlusionTexture"))
+                while (scan < triangleCount && used[scan])
                 {
-                    json OCCLUSION_TEXTURE = MATERIAL["occlusionTexture"];
-                    int index = OCCLUSION_TEXTURE["index"];
-                    material.occlusionTexture = MaterialOcclusionTextureInfo(index);
-                    if (OCCLUSION_TEXTURE.contains("strength"))
-                    {
-                        material.occlusionTexture.strength = OCCLUSION_TEXTURE["strength"];
-                    }
-                    if (OCCLUSION_TEXTURE.contains("texCoord"))
-                    {
-                        material.occlusionTexture.texCoord = OCCLUSION_TEXTURE["texCoord"];
-                    }
+                    scan++;
                 }
-                if (MATERIAL.contains("pbrMetallicRoughness"))
+                if (scan == triangleCount)
                 {
-                    json PBR_METALLIC_ROUGHNESS = MATERIAL["pbrMetallicRoughness"];
-                    MaterialPBRMetallicRoughness pbrMetallicRoughness;
-                    if (PBR_METALLIC_ROUGHNESS.contains("baseColorFactor"))
-                    {
-                        json BASE_COLOR_FACTOR = PBR_METALLIC_ROUGHNESS["baseColorFactor"];
-                        for (int j = 0; j < BASE_COLOR_FACTOR.size(); j++)
-                        {
-                            pbrMetallicRoughness.baseColorFactor[j] = BASE_COLOR_FACTOR.at(j);
-                        }
-                    }
-                    if (PBR_METALLIC_ROUGHNESS.contains("baseColorTexture"))
-                    {
-                        json BASE_COLOR_TEXTURE = PBR_METALLIC_ROUGHNESS["baseColorTexture"];
-                        int index = BASE_COLOR_TEXTURE["index"];
-                        TextureInfo baseColorTexture = TextureInfo(index);
-                        if (BASE_COLOR_TEXTURE.contains("texCoord"))
-                        {
-                            baseColorTexture.texCoord = BASE_COLOR_TEXTURE["texCoord"];
-                        }
-                        pbrMetallicRoughness.baseColorTexture = baseColorTexture;
-                    }
-                    if (PBR_METALLIC_ROUGHNESS.contains("metallicFactor"))
-                    {
-                        pbrMetallicRoughness.metallicFactor = PBR_METALLIC_ROUGHNESS["metallicFactor"];
-                    }
-                    if (PBR_METALLIC_ROUGHNESS.contains("metallicRoughnessTexture"))
-                    {
-                        json METALLIC_ROUGHNESS_TEXTURE = PBR_METALLIC_ROUGHNESS["metallicRoughnessTexture"];
-                        int index = METALLIC_ROUGHNESS_TEXTURE["index"];
-                        TextureInfo metallicRoughnessTexture = TextureInfo(index);
-                        if (METALLIC_ROUGHNESS_TEXTURE.contains("texCoord"))
-                        {
-                            metallicRoughnessTexture.texCoord = METALLIC_ROUGHNESS_TEXTURE["texCoord"];
-                        }
-                        pbrMetallicRoughness.metallicRoughnessTexture = metallicRoughnessTexture;
-                    }
-                    if (PBR_METALLIC_ROUGHNESS.contains("roughnessFactor"))
-                    {
-                        pbrMetallicRoughness.roughnessFactor = PBR_METALLIC_ROUGHNESS["roughnessFactor"];
-                    }
-                    material.pbrMetallicRoughness = pbrMetallicRoughness;
+                    break;
                 }
-                gltf.materials.push_back(material);
+                best = (int64_t)scan;
             }
-        }
-        if (GLTF.contains("meshes"))
-        {
-            json MESHES = GLTF["meshes"];
-            for (int i = 0; i < MESHES.size(); i++)
+            used[best] = 1;
+            for (int c = 0; c < 3; c++)
             {
-                json MESH = MESHES.at(i);
-                json PRIMITIVES = MESH["primitives"];
-                std::vector<MeshPrimitive> primitives;
-                for (int j = 0; j < PRIMITIVES.size(); j++)
+                uint32_t v = indices[best * 3 + c];
+                live[v]--;
+                if (local[v] < 0)
                 {
-                    json PRIMITIVE = PRIMITIVES.at(j);
-                    json ATTRIBUTES = PRIMITIVE["attributes"];
-                    std::vector<std::pair<std::string, int>> attributes;
-                    for (json::iterator it = ATTRIBUTES.begin(); it != ATTRIBUTES.end(); ++it)
-                    {
-                        attributes.push_back(std::make_pair(it.key(), it.value()));
-                    }
-                    MeshPrimitive primitive(attributes);
-                    primitive.indices = PRIMITIVE.value("indices", -1);
-                    primitive.material = PRIMITIVE.value("material", -1);
-                    if (PRIMITIVE.contains("mode"))
+                    local[v] = (int)meshlet.vertexCount++;
+                    set.vertices.push_back(v);
+                    for (int x = 0; x < 3; x++)
                     {
-                        primitive.mode = PRIMITIVE["mode"];
+                        sum[x] += positions[v * 3 + x];
                     }
-                    primitives.push_back(primitive);
                 }
-                Mesh mesh(primitives);
-                mesh.name = MESH.value("name", "");
-                if (MESH.contains("weights"))
+                set.triangles.push_back((uint8_t)local[v]);
+            }
+            if (++meshlet.triangleCount == maxTriangles)
+            {
+                FinishMeshlet(set, meshlet, local, positions);
+                std::fill(sum, sum + 3, 0.0f);
+            }
+        }
+        return set;
+    }
+    struct MeshletOptions
+    {
+        size_t maxVertices = 64;
+        size_t maxTriangles = 124;
+        int threads = 1;
+
+        MeshletOptions() = default;
+        MeshletOptions(size_t _maxVertices, size_t _maxTriangles, int _threads = 1) : maxVertices(_maxVertices), maxTriangles(_maxTriangles), threads(_threads){}
+    };
+    struct PrimitiveMeshlets
+    {
+        int mesh = -1;
+        int primitive = -1;
+        MeshletSet meshlets;
+    };
+    std::vector<PrimitiveMeshlets> BuildMeshlets(const glTF &gltf, AssetLoader &loader, const MeshletOptions &options = MeshletOptions())
+    {
+        std::vector<PrimitiveMeshlets> result;
+        std::vector<PrimitiveTriangles> data;
+        for (size_t m = 0; m < gltf.meshes.size(); m++)
+        {
+            for (size_t p = 0; p < gltf.meshes[m].primitives.size(); p++)
+            {
+                PrimitiveTriangles triangles;
+                if (!ReadPrimitiveTriangles(gltf, loader, gltf.meshes[m].primitives[p], triangles))
                 {
-                    json WEIGHTS = MESH["weights"];
-                    for (int j = 0; j < WEIGHTS.size(); j++)
-                    {
-                        int weight = WEIGHTS.at(j);
-                        mesh.weights.push_back(weight);
-                    }
+                    continue;
                 }
-                gltf.meshes.push_back(mesh);
+                result.emplace_back();
+                result.back().mesh = (int)m;
+                result.back().primitive = (int)p;
+                data.push_back(std::move(triangles));
+            }
+        }
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            tasks.push_back([&, i]()
+            {
+                result[i].meshlets = BuildMeshlets(data[i].indices.data(), data[i].indices.size(), data[i].positions.data(), data[i].positions.size() / 3, options.maxVertices, options.maxTriangles);
+            });
+        }
+        RunTasks(tasks, options.threads);
+        return result;
+    }
+    struct Quadric
+    {
+        float a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+        float b0 = 0, b1 = 0, b2 = 0, c = 0;
+        float weight = 0;
+
+        void AddPlane(const float *n, float d, float w)
+        {
+            a00 += w * n[0] * n[0];
+            a11 += w * n[1] * n[1];
+            a22 += w * n[2] * n[2];
+            a01 += w * n[0] * n[1];
+            a02 += w * n[0] * n[2];
+            a12 += w * n[1] * n[2];
+            b0 += w * n[0] * d;
+            b1 += w * n[1] * d;
+            b2 += w * n[2] * d;
+            c += w * d * d;
+            weight += w;
+        }
+        Quadric &operator+=(const Quadric &other)
+        {
+            a00 += other.a00;
+            a11 += other.a11;
+            a22 += other.a22;
+            a01 += other.a01;
+            a02 += other.a02;
+            a12 += other.a12;
+            b0 += other.b0;
+            b1 += other.b1;
+            b2 += other.b2;
+            c += other.c;
+            weight += other.weight;
+            return *this;
+        }
+        float Error(const float *p) const
+        {
+            float x = p[0], y = p[1], z = p[2];
+            float r = a00 * x * x + a11 * y * y + a22 * z * z + 2 * (a01 * x * y + a02 * x * z + a12 * y * z) + 2 * (b0 * x + b1 * y + b2 * z) + c;
+            return weight > 0 ? std::fabs(r) / weight : 0.0f;
+        }
+    };
+    struct EdgeCollapse
+    {
+        float cost;
+        uint32_t from;
+        uint32_t to;
+
+        bool operator<(const EdgeCollapse &other) const
+        {
+            return cost != other.cost ? cost < other.cost : from != other.from ? from < other.from : to < other.to;
+        }
+    };
+    int CountEdgeTriangles(const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &adjacency, const std::vector<uint32_t> &corners, uint32_t a, uint32_t b)
+    {
+        int count = 0;
+        for (uint32_t j = offsets[a]; j < offsets[a + 1]; j++)
+        {
+            const uint32_t *triangle = &corners[adjacency[j] * 3];
+            count += triangle[0] == b || triangle[1] == b || triangle[2] == b;
+        }
+        return count;
+    }
+    void TriangleNormal(const float *a, const float *b, const float *c, float *n)
+    {
+        float e1[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float e2[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+    }
+    size_t SimplifyMesh(const uint32_t *indices, size_t indexCount, const float *positions, size_t vertexCount, size_t targetIndexCount, uint32_t *out, float maxError = std::numeric_limits<float>::max(), float *resultError = nullptr)
+    {
+        std::vector<uint32_t> current(indices, indices + indexCount / 3 * 3);
+        targetIndexCount = std::max(targetIndexCount / 3 * 3, (size_t)3);
+        float lo[3] = {0, 0, 0};
+        float hi[3] = {0, 0, 0};
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            for (int x = 0; x < 3; x++)
+            {
+                lo[x] = v ? std::min(lo[x], positions[v * 3 + x]) : positions[x];
+                hi[x] = v ? std::max(hi[x], positions[v * 3 + x]) : positions[x];
             }
         }
-        if (GLTF.contains("textures"))
+        float extent = std::max(hi[0] - lo[0], std::max(hi[1] - lo[1], hi[2] - lo[2]));
+        extent = extent > 0 ? extent : 1.0f;
+        std::vector<float> points(vertexCount * 3);
+        for (size_t i = 0; i < points.size(); i++)
+        {
+            points[i] = (positions[i] - lo[i % 3]) / extent;
+        }
+
+        std::vector<uint32_t> position(vertexCount);
+        std::vector<uint32_t> identity(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            identity[v] = (uint32_t)v;
+        }
+        size_t classCount = GenerateVertexRemap(std::vector<VertexStream>(1, VertexStream((const unsigned char*)positions, 12)), vertexCount, identity.data(), vertexCount, position.data());
+        std::vector<uint32_t> classFirst(classCount, ~0u);
+        std::vector<uint32_t> wedgeNext(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
         {
-            json TEXTURES = GLTF["textures"];
-            for (int i = 0; i < TEXTURES.size(); i++)
+            uint32_t &first = classFirst[position[v]];
+            if (first == ~0u)
+            {
+                first = (uint32_t)v;
+                wedgeNext[v] = (uint32_t)v;
+            }
+            else
             {
-                json TEXTURE = TEXTURES.at(i);
-                Texture texture;
-                texture.name = TEXTURE.value("name", "");
-                texture.sampler = TEXTURE.value("sampler", -1);
-                texture.source = TEXTURE.value("source", -1);
-                gltf.textures.push_back(texture);
+                wedgeNext[v] = wedgeNext[first];
+                wedgeNext[first] = (uint32_t)v;
             }
         }
-        if (GLTF.contains("images"))
+
+        std::vector<uint32_t> corners;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> adjacency;
+        for (size_t i = 0; i < current.size(); i += 3)
         {
-            json IMAGES = GLTF["images"];
-            for (int i = 0; i < IMAGES.size(); i++)
+            uint32_t a = position[current[i]];
+            uint32_t b = position[current[i + 1]];
+            uint32_t c = position[current[i + 2]];
+            if (a != b && b != c && a != c)
             {
-                json IMAGE = IMAGES.at(i);
-                Image image;
-                image.bufferView = IMAGE.value("bufferView", -1);
-                image.mimeType = IMAGE.value("mimeType", "");
-                image.name = IMAGE.value("name", "");
-                image.uri = IMAGE.value("uri", "");
-                gltf.images.push_back(image);
+                corners.push_back(a);
+                corners.push_back(b);
+                corners.push_back(c);
+                current[corners.size() - 3] = current[i];
+                current[corners.size() - 2] = current[i + 1];
+                current[corners.size() - 1] = current[i + 2];
             }
         }
-        if (GLTF.contains("skins"))
+        current.resize(corners.size());
+        BuildTriangleAdjacency(corners.data(), corners.size() / 3, classCount, offsets, adjacency);
+        std::vector<Quadric> quadrics(classCount);
+        std::vector<uint8_t> borderEdges(classCount);
+        for (size_t t = 0; t < corners.size() / 3; t++)
         {
-            json SKINS = GLTF["skins"];
-            for (int i = 0; i < SKINS.size(); i++)
+            const uint32_t *triangle = &corners[t * 3];
+            float n[3];
+            TriangleNormal(&points[classFirst[triangle[0]] * 3], &points[classFirst[triangle[1]] * 3], &points[classFirst[triangle[2]] * 3], n);
+            float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            if (area <= 0)
+            {
+                continue;
+            }
+            for (int x = 0; x < 3; x++)
+            {
+                n[x] /= area;
+            }
+            const float *p0 = &points[classFirst[triangle[0]] * 3];
+            float d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            for (int k = 0; k < 3; k++)
+            {
+                quadrics[triangle[k]].AddPlane(n, d, area);
+            }
+            for (int k = 0; k < 3; k++)
             {
-                json SKIN = SKINS.at(i);
-                json JOINTS = SKIN["joints"];
-                std::vector<int> joints;
-                for (int j = 0; j < JOINTS.size(); j++)
+                uint32_t a = triangle[k];
+                uint32_t b = triangle[(k + 1) % 3];
+                if (a == b || CountEdgeTriangles(offsets, adjacency, corners, a, b) != 1)
                 {
-                    int joint = JOINTS.at(j);
-                    joints.push_back(joint);
+                    continue;
                 }
-                Skin skin(joints);
-                skin.inverseBindMatrices = SKIN.value("inverseBindMatrices", -1);
-                skin.name = SKIN.value("name", "");
-                skin.skeleton = SKIN.value("skeleton", -1);
-                gltf.skins.push_back(skin);
+                borderEdges[a] = (uint8_t)std::min(borderEdges[a] + 1, 255);
+                borderEdges[b] = (uint8_t)std::min(borderEdges[b] + 1, 255);
+                const float *pa = &points[classFirst[a] * 3];
+                const float *pb = &points[classFirst[b] * 3];
+                float e[3] = {pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2]};
+                float m[3] = {e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0]};
+                float length = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+                if (length <= 0)
+                {
+                    continue;
+                }
+                for (int x = 0; x < 3; x++)
+                {
+                    m[x] /= length;
+                }
+                float md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+                quadrics[a].AddPlane(m, md, length * 10);
+                quadrics[b].AddPlane(m, md, length * 10);
             }
-
         }
-        if (GLTF.contains("accessors"))
+
+        float limit = maxError < std::sqrt(std::numeric_limits<float>::max()) ? maxError * maxError : std::numeric_limits<float>::max();
+        float worst = 0;
+        std::vector<uint32_t> collapse(vertexCount);
+        std::vector<char> locked(classCount);
+        std::vector<EdgeCollapse> candidates;
+        std::vector<std::pair<uint32_t, uint32_t>> matches;
+        std::vector<std::pair<uint32_t, uint32_t>> pending;
+        while (current.size() > targetIndexCount)
         {
-            json ACCESSORS = GLTF["accessors"];
-            for (int i = 0; i < ACCESSORS.size(); i++)
+            corners.resize(current.size());
+            for (size_t i = 0; i < current.size(); i++)
+            {
+                corners[i] = position[current[i]];
+            }
+            BuildTriangleAdjacency(corners.data(), corners.size() / 3, classCount, offsets, adjacency);
+            candidates.clear();
+            for (size_t i = 0; i < corners.size(); i++)
             {
-                json ACCESSOR = ACCESSORS.at(i);
-                int componentType = ACCESSOR["componentType"];
-                int count = ACCESSOR["count"];
-                std::string type = ACCESSOR["type"];
-                Accessor accessor(componentType, count, type);
-                accessor.bufferView = ACCESSOR.value("bufferView", -1);
-                if (ACCESSOR.contains("byteOffset"))
+                uint32_t a = corners[i];
+                uint32_t b = corners[i - i % 3 + (i + 1) % 3];
+                if (a == b)
                 {
-                    accessor.byteOffset = ACCESSOR["byteOffset"];
+                    continue;
+                }
+                bool border = (borderEdges[a] || borderEdges[b]) && CountEdgeTriangles(offsets, adjacency, corners, a, b) == 1;
+                if (!border && a > b)
+                {
+                    continue;
+                }
+                EdgeCollapse best = {std::numeric_limits<float>::max(), a, b};
+                for (int direction = 0; direction < 2; direction++)
+                {
+                    uint32_t from = direction ? b : a;
+                    uint32_t to = direction ? a : b;
+                    if (borderEdges[from] && (borderEdges[from] != 2 || !border))
+                    {
+                        continue;
+                    }
+                    Quadric merged = quadrics[from];
+                    merged += quadrics[to];
+                    float cost = merged.Error(&points[classFirst[to] * 3]);
+                    if (cost < best.cost)
+                    {
+                        best.cost = cost;
+                        best.from = from;
+                        best.to = to;
+                    }
                 }
-                if (ACCESSOR.contains("normalized"))
+                if (best.cost <= limit)
                 {
-                    accessor.normalized = ACCESSOR["normalized"];
+                    candidates.push_back(best);
                 }
-                accessor.count = ACCESSOR.value("count", -1);
-                if (ACCESSOR.contains("min"))
+            }
+            if (candidates.empty())
+            {
+                break;
+            }
+            size_t needed = (current.size() - targetIndexCount + 2) / 3;
+            std::vector<EdgeCollapse>::iterator last = candidates.begin() + std::min(candidates.size(), std::max(needed, candidates.size() / 4));
+            std::nth_element(candidates.begin(), last, candidates.end());
+            std::sort(candidates.begin(), last);
+            std::fill(locked.begin(), locked.end(), 0);
+            pending.clear();
+            size_t removed = 0;
+            for (std::vector<EdgeCollapse>::iterator it = candidates.begin(); it != candidates.end() && removed < needed; ++it)
+            {
+                if (it == last)
                 {
-                    json MIN = ACCESSOR["min"];
-                    for (int j = 0; j < MIN.size(); j++)
+                    if (!pending.empty())
                     {
-                        accessor.min.push_back(MIN.at(j));
+                        break;
                     }
+                    last = candidates.end();
+                    std::sort(it, last);
+                }
+                const EdgeCollapse &candidate = *it;
+                if ((locked[candidate.from] & 1) || (locked[candidate.to] & 2))
+                {
+                    continue;
+                }
+                size_t shared = (size_t)CountEdgeTriangles(offsets, adjacency, corners, candidate.from, candidate.to);
+                if (removed + shared >= current.size() / 3)
+                {
+                    continue;
                 }
-                if (ACCESSOR.contains("max"))
+                bool valid = true;
+                matches.clear();
+                uint32_t w = classFirst[candidate.from];
+                do
+                {
+                    uint32_t target = ~0u;
+                    bool seen = false;
+                    for (uint32_t j = offsets[candidate.from]; valid && j < offsets[candidate.from + 1]; j++)
+                    {
+                        const uint32_t *triangle = &current[adjacency[j] * 3];
+                        const uint32_t *classes = &corners[adjacency[j] * 3];
+                        if (triangle[0] != w && triangle[1] != w && triangle[2] != w)
+                        {
+                            continue;
+                        }
+                        seen = true;
+                        for (int k = 0; k < 3; k++)
+                        {
+                            if (classes[k] == candidate.to)
+                            {
+                                valid = target == ~0u || target == triangle[k];
+                                target = triangle[k];
+                            }
+                        }
+                    }
+                    if (seen)
+                    {
+                        valid = valid && target != ~0u;
+                        matches.push_back(std::make_pair(w, target));
+                    }
+                    w = wedgeNext[w];
+                } while (valid && w != classFirst[candidate.from]);
+                const float *to = &points[classFirst[candidate.to] * 3];
+                for (uint32_t j = offsets[candidate.from]; valid && j < offsets[candidate.from + 1]; j++)
                 {
-                    json MAX = ACCESSOR["max"];
-                    for (int j = 0; j < MAX.size(); j++)
+                    const uint32_t *classes = &corners[adjacency[j] * 3];
+                    if (classes[0] == candidate.to || classes[1] == candidate.to || classes[2] == candidate.to)
                     {
-                        accessor.max.push_back(MAX.at(j));
+                        continue;
                     }
+                    int k = classes[0] == candidate.from ? 0 : classes[1] == candidate.from ? 1 : 2;
+                    const float *b = &points[classFirst[classes[(k + 1) % 3]] * 3];
+                    const float *c = &points[classFirst[classes[(k + 2) % 3]] * 3];
+                    float before[3];
+                    float after[3];
+                    TriangleNormal(&points[classFirst[candidate.from] * 3], b, c, before);
+                    TriangleNormal(to, b, c, after);
+                    float lengths = std::sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) * (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+                    valid = before[0] * after[0] + before[1] * after[1] + before[2] * after[2] > 0.25f * lengths;
+                }
+                if (!valid)
+                {
+                    continue;
+                }
+                pending.insert(pending.end(), matches.begin(), matches.end());
+                quadrics[candidate.to] += quadrics[candidate.from];
+                for (uint32_t j = offsets[candidate.from]; j < offsets[candidate.from + 1]; j++)
+                {
+                    const uint32_t *classes = &corners[adjacency[j] * 3];
+                    locked[classes[0]] |= 1;
+                    locked[classes[1]] |= 1;
+                    locked[classes[2]] |= 1;
                 }
-                gltf.accessors.push_back(accessor);
+                locked[candidate.from] |= 2;
+                removed += shared;
+                worst = std::max(worst, candidate.cost);
             }
-        }
-        if (GLTF.contains("bufferViews"))
-        {
-            json BUFFER_VIEWS = GLTF["bufferViews"];
-            for (int i = 0; i < BUFFER_VIEWS.size(); i++)
+            if (pending.empty())
+            {
+                break;
+            }
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                collapse[v] = (uint32_t)v;
+            }
+            for (const std::pair<uint32_t, uint32_t> &match : pending)
+            {
+                collapse[match.first] = match.second;
+            }
+            size_t kept = 0;
+            for (size_t i = 0; i < current.size(); i += 3)
             {
-                json BUFFER_VIEW = BUFFER_VIEWS.at(i);
-                int buffer = BUFFER_VIEW["buffer"];
-                int byteLength = BUFFER_VIEW["byteLength"];
-                BufferView bufferView(buffer, byteLength);
-                bufferView.byteOffset = BUFFER_VIEW.value("byteOffset", 0);
-                bufferView.byteStride = BUFFER_VIEW.value("byteStride", -1);
-                bufferView.name = BUFFER_VIEW.value("name", "");
-                bufferView.target = BUFFER_VIEW.value("target", -1);
-                gltf.bufferViews.push_back(bufferView);
+                uint32_t a = collapse[current[i]];
+                uint32_t b = collapse[current[i + 1]];
+                uint32_t c = collapse[current[i + 2]];
+                if (position[a] == position[b] || position[b] == position[c] || position[a] == position[c])
+                {
+                    continue;
+                }
+                current[kept++] = a;
+                current[kept++] = b;
+                current[kept++] = c;
             }
+            current.resize(kept);
+        }
+        std::copy(current.begin(), current.end(), out);
+        if (resultError)
+        {
+            *resultError = std::sqrt(worst);
         }
-        if (GLTF.contains("samplers"))
+        return current.size();
+    }
+    struct LodOptions
+    {
+        std::vector<float> ratios = {0.5f, 0.25f, 0.125f};
+        float maxError = std::numeric_limits<float>::max();
+        int threads = 1;
+
+        LodOptions() = default;
+        LodOptions(std::vector<float> _ratios, int _threads = 1) : ratios(std::move(_ratios)), threads(_threads){}
+    };
+    struct PrimitiveLODs
+    {
+        int mesh = -1;
+        int primitive = -1;
+        std::vector<MeshPrimitive> levels;
+        std::vector<float> errors;
+    };
+    std::vector<PrimitiveLODs> GenerateLODs(glTF &gltf, AssetLoader &loader, const LodOptions &options = LodOptions())
+    {
+        std::vector<PrimitiveLODs> result;
+        std::vector<PrimitiveTriangles> data;
+        for (size_t m = 0; m < gltf.meshes.size(); m++)
         {
-            json SAMPLERS = GLTF["samplers"];
-            for (int i = 0; i < SAMPLERS.size(); i++)
+            for (size_t p = 0; p < gltf.meshes[m].primitives.size(); p++)
             {
-                json SAMPLER = SAMPLERS.at(i);
-                Sampler sampler;
-                sampler.magFilter = SAMPLER.value("magFilter", -1);
-                sampler.minFilter = SAMPLER.value("minFilter", -1);
-                sampler.name = SAMPLER.value("name", "");
-                if (SAMPLER.contains("wrapS"))
+                PrimitiveTriangles triangles;
+                if (!ReadPrimitiveTriangles(gltf, loader, gltf.meshes[m].primitives[p], triangles))
                 {
-                    sampler.wrapS = SAMPLER["wrapS"];
+                    continue;
                 }
-                if (SAMPLER.contains("wrapT"))
+                result.emplace_back();
+                result.back().mesh = (int)m;
+                result.back().primitive = (int)p;
+                data.push_back(std::move(triangles));
+            }
+        }
+        std::vector<std::vector<std::vector<uint32_t>>> levels(result.size());
+        std::vector<std::function<void()>> tasks;
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            tasks.push_back([&, i]()
+            {
+                const std::vector<uint32_t> *source = &data[i].indices;
+                size_t vertexCount = data[i].positions.size() / 3;
+                for (float ratio : options.ratios)
                 {
-                    sampler.wrapT = SAMPLER["wrapT"];
+                    size_t target = (size_t)(data[i].indices.size() / 3 * std::max(0.0f, std::min(1.0f, ratio))) * 3;
+                    std::vector<uint32_t> lod(source->size());
+                    float error = 0;
+                    lod.resize(SimplifyMesh(source->data(), source->size(), data[i].positions.data(), vertexCount, target, lod.data(), options.maxError, &error));
+                    if (lod.empty() || (!levels[i].empty() && lod.size() == source->size()))
+                    {
+                        break;
+                    }
+                    levels[i].push_back(std::move(lod));
+                    result[i].errors.push_back(std::max(error, result[i].errors.size() ? result[i].errors.back() : 0.0f));
+                    source = &levels[i].back();
                 }
-                gltf.samplers.push_back(sampler);
-            }
-
+            });
         }
-        if (GLTF.contains("buffers"))
+        RunTasks(tasks, options.threads);
+        BufferBuilder builder(gltf);
+        for (size_t i = 0; i < result.size(); i++)
         {
-            json BUFFERS = GLTF["buffers"];
-            for (int i = 0; i < BUFFERS.size(); i++)
+            for (const std::vector<uint32_t> &lod : levels[i])
             {
-                json BUFFER = BUFFERS.at(i);
-                int byteLength = BUFFER["byteLength"];
-                Buffer buffer(byteLength);
-                buffer.name = BUFFER.value("name", "");
-                buffer.uri = BUFFER.value("uri", "");
-                gltf.buffers.push_back(buffer);
+                MeshPrimitive level = gltf.meshes[result[i].mesh].primitives[result[i].primitive];
+                level.indices = builder.AddIndices(lod.data(), lod.size(), data[i].positions.size() / 3);
+                result[i].levels.push_back(std::move(level));
             }
         }
-        return gltf;
-    }
-    struct AccessResult
-    {
-        const Accessor* accessor;
-        const BufferView* bufferView;
-        const Buffer* buffer;
-    };
-    AccessResult Access(const glTF &gltf, int accessorId)
-    {
-        AccessResult result;
-        result.accessor = &(gltf.accessors[accessorId]);
-        result.bufferView = &(gltf.bufferViews[result.accessor->bufferView]);
-        result.buffer = &(gltf.buffers[result.bufferView->buffer]);
-
+        builder.Finish();
         return result;
     }
 }
@@ -756,5 +7497,8 @@ namespace gltf{
 //
 //};
 
+#ifdef _WIN32
+#pragma pop_macro("OPAQUE")
+#endif
 
 #endif //ZEROSKYLINE_GLTF_H
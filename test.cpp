@@ -0,0 +1,324 @@
+#include "gltf.h"
+#include <iostream>
+#include <random>
+
+static int failures = 0;
+
+static void Check(bool condition, const std::string &what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::string EncodeBase64(const std::vector<unsigned char> &data)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    for (size_t i = 0; i < data.size(); i += 3)
+    {
+        uint32_t bits = (uint32_t)data[i] << 16;
+        if (i + 1 < data.size())
+        {
+            bits |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < data.size())
+        {
+            bits |= data[i + 2];
+        }
+        result += alphabet[bits >> 18];
+        result += alphabet[(bits >> 12) & 63];
+        result += i + 1 < data.size() ? alphabet[(bits >> 6) & 63] : '=';
+        result += i + 2 < data.size() ? alphabet[bits & 63] : '=';
+    }
+    return result;
+}
+
+template<typename T>
+static void Append(std::vector<unsigned char> &bytes, std::initializer_list<T> values)
+{
+    for (T value : values)
+    {
+        const unsigned char *p = (const unsigned char*)&value;
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+    while (bytes.size() % 4)
+    {
+        bytes.push_back(0);
+    }
+}
+
+static std::string SampleJSON(const std::vector<unsigned char> &bytes)
+{
+    return std::string(R"({
+        "asset": {"version": "2.0", "generator": "test"},
+        "scene": 0,
+        "scenes": [{"nodes": [0], "name": "scene"}],
+        "nodes": [
+            {"children": [1], "matrix": [1,0,0,0, 0,1,0,0, 0,0,1,0, 1,2,3,1]},
+            {"mesh": 0, "skin": 0, "translation": [0,1,0], "rotation": [0,0,0,1], "scale": [2,2,2], "camera": 0},
+            {"camera": 1}
+        ],
+        "cameras": [
+            {"type": "perspective", "perspective": {"yfov": 0.8, "znear": 0.1, "zfar": 100, "aspectRatio": 1.5}},
+            {"type": "orthographic", "orthographic": {"xmag": 1, "ymag": 1, "zfar": 10, "znear": 0}}
+        ],
+        "meshes": [{"primitives": [{
+            "attributes": {"POSITION": 0, "COLOR_0": 2, "_CUSTOM": 6},
+            "indices": 1,
+            "material": 0,
+            "targets": [{"POSITION": 6}]
+        }], "weights": [0.5]}],
+        "materials": [{"pbrMetallicRoughness": {"baseColorTexture": {"index": 0}, "metallicFactor": 0.25}, "doubleSided": true, "alphaMode": "MASK"}],
+        "textures": [{"source": 0, "sampler": 0}],
+        "samplers": [{"magFilter": 9729, "minFilter": 9987, "wrapS": 33648}],
+        "images": [{"uri": "texture.png"}],
+        "skins": [{"joints": [1], "inverseBindMatrices": 5}],
+        "animations": [{
+            "channels": [{"sampler": 0, "target": {"node": 1, "path": "translation"}}],
+            "samplers": [{"input": 3, "output": 4, "interpolation": "LINEAR"}]
+        }],
+        "accessors": [
+            {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3", "min": [0,0,0], "max": [1,1,0]},
+            {"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"},
+            {"bufferView": 2, "componentType": 5121, "normalized": true, "count": 3, "type": "VEC4"},
+            {"bufferView": 3, "componentType": 5126, "count": 2, "type": "SCALAR", "min": [0], "max": [1]},
+            {"bufferView": 4, "componentType": 5126, "count": 2, "type": "VEC3"},
+            {"bufferView": 5, "componentType": 5126, "count": 1, "type": "MAT4"},
+            {"componentType": 5126, "count": 3, "type": "VEC3", "sparse": {"count": 1, "indices": {"bufferView": 6, "componentType": 5121}, "values": {"bufferView": 7}}}
+        ],
+        "bufferViews": [
+            {"buffer": 0, "byteOffset": 0, "byteLength": 36},
+            {"buffer": 0, "byteOffset": 36, "byteLength": 6},
+            {"buffer": 0, "byteOffset": 44, "byteLength": 12},
+            {"buffer": 0, "byteOffset": 56, "byteLength": 8},
+            {"buffer": 0, "byteOffset": 64, "byteLength": 24},
+            {"buffer": 0, "byteOffset": 88, "byteLength": 64},
+            {"buffer": 0, "byteOffset": 152, "byteLength": 1},
+            {"buffer": 0, "byteOffset": 156, "byteLength": 12}
+        ],
+        "buffers": [{"byteLength": )") + std::to_string(bytes.size()) + R"(, "uri": "data:application/octet-stream;base64,)" + EncodeBase64(bytes) + R"("}]
+    })";
+}
+
+static void TestRoundTrip(const std::string &text)
+{
+    gltf::glTF parsed = gltf::Parse(text);
+    std::string serialized = gltf::Serialize(parsed);
+    gltf::glTF reparsed = gltf::Parse(serialized);
+    Check(gltf::Serialize(reparsed) == serialized, "Parse -> Serialize -> Parse round trip");
+
+    gltf::AssetLoader loader(reparsed, "./");
+    std::vector<float> positions = loader.ReadAsFloat(0);
+    Check(positions.size() == 9 && positions[3] == 1 && positions[7] == 1, "positions after round trip");
+    std::vector<uint32_t> indices = loader.ReadIndices(1);
+    Check(indices == std::vector<uint32_t>({0, 1, 2}), "indices after round trip");
+    std::vector<float> colors = loader.ReadAsFloat(2);
+    Check(colors.size() == 12 && colors[0] == 1 && colors[1] == 0 && std::fabs(colors[4] - 128 / 255.0f) < 1e-6f, "normalized colors after round trip");
+    std::vector<float> sparse = loader.ReadAsFloat(6);
+    Check(sparse.size() == 9 && sparse[3] == 4 && sparse[4] == 5 && sparse[5] == 6 && sparse[0] == 0, "sparse accessor after round trip");
+}
+
+static void TestStreaming(const std::string &text)
+{
+    Check(gltf::Serialize(gltf::ParseStreaming(text)) == gltf::Serialize(gltf::Parse(text)), "ParseStreaming matches Parse");
+
+    const char *invalid[] = {
+        R"({})",
+        R"({"asset": {}})",
+        R"({"asset": {"version": "2.0"}, "meshes": [{}]})",
+        R"({"asset": {"version": "2.0"}, "meshes": [{"primitives": [{}]}]})",
+        R"({"asset": {"version": "2.0"}, "accessors": [{"count": 1, "type": "SCALAR"}]})",
+        R"({"asset": {"version": "2.0"}, "bufferViews": [{"buffer": 0}]})",
+        R"({"asset": {"version": "2.0"}, "cameras": [{"type": "perspective", "perspective": {"yfov": 1}}]})",
+        R"({"asset": {"version": "2.0"}, "animations": [{"channels": [{"sampler": 0, "target": {}}], "samplers": []}]})"
+    };
+    for (const char *json : invalid)
+    {
+        std::string dom;
+        std::string sax;
+        try
+        {
+            gltf::Parse(json);
+        }
+        catch (const std::exception &e)
+        {
+            dom = e.what();
+        }
+        try
+        {
+            gltf::ParseStreaming(json);
+        }
+        catch (const std::exception &e)
+        {
+            sax = e.what();
+        }
+        Check(!dom.empty() && dom == sax, std::string("ParseStreaming rejects like Parse: ") + json);
+    }
+}
+
+static void TestCache(const std::string &text)
+{
+    gltf::glTF parsed = gltf::Parse(text);
+    std::vector<unsigned char> cache = gltf::SaveCache(parsed, 42);
+    gltf::glTF loaded = gltf::LoadCache(cache.data(), cache.size(), 42);
+    Check(gltf::Serialize(loaded) == gltf::Serialize(parsed), "LoadCache matches the saved document");
+
+    gltf::AssetLoader before(parsed, "./");
+    gltf::AssetLoader after(loaded, "./");
+    for (size_t i = 0; i < parsed.accessors.size(); i++)
+    {
+        Check(before.ReadAsFloat((int)i) == after.ReadAsFloat((int)i), "cached accessor " + std::to_string(i));
+    }
+
+    bool rejected = false;
+    try
+    {
+        gltf::LoadCache(cache.data(), cache.size(), 43);
+    }
+    catch (const std::exception&)
+    {
+        rejected = true;
+    }
+    Check(rejected, "LoadCache rejects a different source key");
+}
+
+static void TestBase64(std::mt19937 &rng)
+{
+    for (size_t size = 0; size < 200; size++)
+    {
+        std::vector<unsigned char> data(size);
+        for (unsigned char &c : data)
+        {
+            c = (unsigned char)rng();
+        }
+        std::string encoded = EncodeBase64(data);
+        std::vector<unsigned char> decoded(gltf::Base64DecodedSize(encoded.data(), encoded.size()));
+        size_t written = gltf::DecodeBase64(encoded.data(), encoded.size(), decoded.data());
+        Check(written == size && decoded == data, "base64 decode of " + std::to_string(size) + " bytes");
+
+        for (size_t offset = 0; offset < encoded.size() && encoded[offset] != '='; offset += 7)
+        {
+            std::string corrupt = encoded;
+            corrupt[offset] = '*';
+            bool rejected = false;
+            try
+            {
+                gltf::DecodeBase64(corrupt.data(), corrupt.size(), decoded.data());
+            }
+            catch (const std::invalid_argument&)
+            {
+                rejected = true;
+            }
+            Check(rejected, "base64 rejects an invalid character at offset " + std::to_string(offset) + " of " + std::to_string(encoded.size()));
+        }
+    }
+}
+
+static float ReferenceFloat(const unsigned char *src, int componentType, bool normalized)
+{
+    switch (componentType)
+    {
+        case 5120: return normalized ? std::max((signed char)src[0] / 127.0f, -1.0f) : (float)(signed char)src[0];
+        case 5121: return normalized ? src[0] / 255.0f : (float)src[0];
+        case 5122:
+        {
+            int16_t v;
+            std::memcpy(&v, src, 2);
+            return normalized ? std::max(v / 32767.0f, -1.0f) : (float)v;
+        }
+        case 5123:
+        {
+            uint16_t v;
+            std::memcpy(&v, src, 2);
+            return normalized ? v / 65535.0f : (float)v;
+        }
+        case 5125:
+        {
+            uint32_t v;
+            std::memcpy(&v, src, 4);
+            return (float)v;
+        }
+        default:
+        {
+            float v;
+            std::memcpy(&v, src, 4);
+            return v;
+        }
+    }
+}
+
+static void TestConvertToFloat(std::mt19937 &rng)
+{
+    const int componentTypes[] = {5120, 5121, 5122, 5123, 5125, 5126};
+    for (int componentType : componentTypes)
+    {
+        for (int normalized = 0; normalized < 2; normalized++)
+        {
+            if (normalized && (componentType == 5125 || componentType == 5126))
+            {
+                continue;
+            }
+            for (int components = 1; components <= 4; components++)
+            {
+                for (size_t count = 0; count < 40; count++)
+                {
+                    size_t elementSize = (size_t)gltf::ComponentSize(componentType) * components;
+                    size_t strides[2] = {elementSize, (elementSize + 7) & ~(size_t)3};
+                    for (size_t stride : strides)
+                    {
+                        std::vector<unsigned char> src(count * stride + 4);
+                        for (size_t i = 0; i < src.size(); i += 4)
+                        {
+                            float value = (float)(int)(rng() % 2001) - 1000.0f;
+                            uint32_t bits = (uint32_t)rng();
+                            std::memcpy(&src[i], componentType == 5126 ? (const void*)&value : (const void*)&bits, std::min((size_t)4, src.size() - i));
+                        }
+                        std::vector<float> out(count * components);
+                        gltf::ConvertToFloat(src.data(), stride, count, componentType, components, normalized != 0, out.data());
+                        bool same = true;
+                        for (size_t i = 0; i < count; i++)
+                        {
+                            for (int c = 0; c < components; c++)
+                            {
+                                float expected = ReferenceFloat(&src[i * stride + c * gltf::ComponentSize(componentType)], componentType, normalized != 0);
+                                same = same && std::fabs(out[i * components + c] - expected) <= 1e-6f * std::max(1.0f, std::fabs(expected));
+                            }
+                        }
+                        Check(same, "ConvertToFloat componentType " + std::to_string(componentType) + " normalized " + std::to_string(normalized) + " components " + std::to_string(components) + " count " + std::to_string(count) + " stride " + std::to_string(stride));
+                    }
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    std::vector<unsigned char> bytes;
+    Append<float>(bytes, {0, 0, 0, 1, 0, 0, 0, 1, 0});
+    Append<uint16_t>(bytes, {0, 1, 2});
+    Append<unsigned char>(bytes, {255, 0, 0, 255, 128, 255, 0, 255, 0, 0, 255, 255});
+    Append<float>(bytes, {0, 1});
+    Append<float>(bytes, {0, 0, 0, 0, 1, 0});
+    Append<float>(bytes, {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1});
+    Append<unsigned char>(bytes, {1});
+    Append<float>(bytes, {4, 5, 6});
+    std::string text = SampleJSON(bytes);
+
+    std::mt19937 rng(1);
+    TestRoundTrip(text);
+    TestStreaming(text);
+    TestCache(text);
+    TestBase64(rng);
+    TestConvertToFloat(rng);
+    if (failures)
+    {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}